@@ -0,0 +1,253 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+namespace fakers
+{
+// Where control goes after an instruction, as far as it is known without
+// running it.
+enum class Flow : uint8_t {
+    Next,
+    // Falls through or skips the next instruction.
+    Skip,
+    Jump,
+    // Bnnn: the target depends on a register.
+    JumpIndexed,
+    Call,
+    Return,
+    Exit,
+};
+
+enum class Op : uint8_t {
+    Unknown,
+    Cls,
+    Ret,
+    Sys,
+    ScrollDown,
+    ScrollUp,
+    ScrollRight,
+    ScrollLeft,
+    Exit,
+    LowRes,
+    HighRes,
+    Jump,
+    Call,
+    SkipEqImm,
+    SkipNeImm,
+    SkipEqReg,
+    StoreRange,
+    LoadRange,
+    LoadImm,
+    AddImm,
+    Move,
+    Or,
+    And,
+    Xor,
+    Add,
+    Sub,
+    ShiftRight,
+    SubReverse,
+    ShiftLeft,
+    SkipNeReg,
+    LoadI,
+    JumpIndexed,
+    Rand,
+    Draw,
+    SkipKey,
+    SkipNoKey,
+    LoadLongI,
+    SelectPlanes,
+    GetDelay,
+    WaitKey,
+    SetDelay,
+    SetSound,
+    AddI,
+    Font,
+    BigFont,
+    Bcd,
+    Store,
+    Load,
+    SaveFlags,
+    LoadFlags,
+    Count,
+};
+
+struct OpInfo {
+    Op op;
+    // The enumerator's name, for reports.
+    char const* name;
+    // Mnemonic with {x}, {y}, {n}, {kk}, {nnn} and {long} (the word after
+    // F000) fields, in the vocabulary of the trace listing.
+    char const* syntax;
+    Flow flow;
+    // Leaves the straight line, waits, or writes memory the block engine
+    // may have decoded: a cached block ends after it. Skips stay inside.
+    bool endsBlock;
+    // In bytes.
+    uint8_t length;
+};
+
+// One row per Op, in Op order; shared by the interpreter's block decoder
+// and the disassembler.
+constexpr OpInfo OP_INFO[] = {
+    { Op::Unknown, "Unknown", "", Flow::Next, true, 2 },
+    { Op::Cls, "Cls", "cls", Flow::Next, true, 2 },
+    { Op::Ret, "Ret", "ret", Flow::Return, true, 2 },
+    { Op::Sys, "Sys", "exec pc=0x{nnn}", Flow::Jump, true, 2 },
+    { Op::ScrollDown, "ScrollDown", "scrl down {n}", Flow::Next, true, 2 },
+    { Op::ScrollUp, "ScrollUp", "scrl up {n}", Flow::Next, true, 2 },
+    { Op::ScrollRight, "ScrollRight", "scrl right", Flow::Next, true, 2 },
+    { Op::ScrollLeft, "ScrollLeft", "scrl left", Flow::Next, true, 2 },
+    { Op::Exit, "Exit", "exit", Flow::Exit, true, 2 },
+    { Op::LowRes, "LowRes", "res  low", Flow::Next, true, 2 },
+    { Op::HighRes, "HighRes", "res  high", Flow::Next, true, 2 },
+    { Op::Jump, "Jump", "goto pc=0x{nnn}", Flow::Jump, true, 2 },
+    { Op::Call, "Call", "call pc=0x{nnn}", Flow::Call, true, 2 },
+    { Op::SkipEqImm, "SkipEqImm", "cmp  V{x}==0x{kk}", Flow::Skip, false, 2 },
+    { Op::SkipNeImm, "SkipNeImm", "cmp  V{x}!=0x{kk}", Flow::Skip, false, 2 },
+    { Op::SkipEqReg, "SkipEqReg", "cmp  V{x}==V{y}", Flow::Skip, false, 2 },
+    { Op::StoreRange, "StoreRange", "reg  dump V[{x};{y}]", Flow::Next, true, 2 },
+    { Op::LoadRange, "LoadRange", "reg  load V[{x};{y}]", Flow::Next, true, 2 },
+    { Op::LoadImm, "LoadImm", "asgn V{x}=0x{kk}", Flow::Next, false, 2 },
+    { Op::AddImm, "AddImm", "inc  V{x}+=0x{kk}", Flow::Next, false, 2 },
+    { Op::Move, "Move", "asgn V{x}=V{y}", Flow::Next, false, 2 },
+    { Op::Or, "Or", "asgn V{x}|=V{y}", Flow::Next, false, 2 },
+    { Op::And, "And", "asgn V{x}&=V{y}", Flow::Next, false, 2 },
+    { Op::Xor, "Xor", "asgn V{x}^=V{y}", Flow::Next, false, 2 },
+    { Op::Add, "Add", "asgn V{x}+=V{y}", Flow::Next, false, 2 },
+    { Op::Sub, "Sub", "asgn V{x}-=V{y}", Flow::Next, false, 2 },
+    { Op::ShiftRight, "ShiftRight", "asgn V{x}>>=1", Flow::Next, false, 2 },
+    { Op::SubReverse, "SubReverse", "asgn V{x}=V{y}-V{x}", Flow::Next, false, 2 },
+    { Op::ShiftLeft, "ShiftLeft", "asgn V{x}<<=1", Flow::Next, false, 2 },
+    { Op::SkipNeReg, "SkipNeReg", "cmp  V{x}!=V{y}", Flow::Skip, false, 2 },
+    { Op::LoadI, "LoadI", "reg  I=0x{nnn}", Flow::Next, false, 2 },
+    { Op::JumpIndexed, "JumpIndexed", "goto pc=V0+0x{nnn}", Flow::JumpIndexed, true, 2 },
+    { Op::Rand, "Rand", "rnd  V{x}=rand&0x{kk}", Flow::Next, false, 2 },
+    { Op::Draw, "Draw", "draw V{x};V{y};{n}", Flow::Next, true, 2 },
+    { Op::SkipKey, "SkipKey", "key  V{x} ON", Flow::Skip, false, 2 },
+    { Op::SkipNoKey, "SkipNoKey", "key  V{x} OFF", Flow::Skip, false, 2 },
+    { Op::LoadLongI, "LoadLongI", "reg  I=0x{long}", Flow::Next, true, 4 },
+    { Op::SelectPlanes, "SelectPlanes", "plan {x}", Flow::Next, false, 2 },
+    { Op::GetDelay, "GetDelay", "time V{x}=dt", Flow::Next, false, 2 },
+    { Op::WaitKey, "WaitKey", "key  V{x}=wait", Flow::Next, true, 2 },
+    { Op::SetDelay, "SetDelay", "time dt=V{x}", Flow::Next, false, 2 },
+    { Op::SetSound, "SetSound", "snd  st=V{x}", Flow::Next, false, 2 },
+    { Op::AddI, "AddI", "inc  I+=V{x}", Flow::Next, false, 2 },
+    { Op::Font, "Font", "reg  I=font(V{x})", Flow::Next, false, 2 },
+    { Op::BigFont, "BigFont", "reg  I=bigfont(V{x})", Flow::Next, false, 2 },
+    { Op::Bcd, "Bcd", "bcd  V{x}", Flow::Next, true, 2 },
+    { Op::Store, "Store", "reg  dump V[0;{x}]", Flow::Next, true, 2 },
+    { Op::Load, "Load", "reg  load V[0;{x}]", Flow::Next, false, 2 },
+    { Op::SaveFlags, "SaveFlags", "flag save V[0;{x}]", Flow::Next, false, 2 },
+    { Op::LoadFlags, "LoadFlags", "flag load V[0;{x}]", Flow::Next, false, 2 },
+};
+static_assert(std::size(OP_INFO) == static_cast<size_t>(Op::Count), "one OP_INFO row per Op");
+
+constexpr bool opInfoInOrder() {
+    for (size_t i = 0; i < std::size(OP_INFO); ++i) {
+        if (static_cast<size_t>(OP_INFO[i].op) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(opInfoInOrder(), "OP_INFO rows follow Op");
+
+constexpr OpInfo const& opInfo(Op op) {
+    return OP_INFO[static_cast<size_t>(op)];
+}
+
+// Which instruction an opcode is on a machine with the SUPER-CHIP
+// (`extended`) and XO-CHIP (`xo`) opcodes, as the interpreter executes it.
+// The low nibble of 5xyN and 9xyN is not decoded, so 5xy1-5xyF (other than
+// XO-CHIP's 5xy2 and 5xy3) and 9xy1-9xyF skip like 5xy0 and 9xy0. Other
+// encodings no platform defines are Op::Unknown.
+constexpr Op decodeOp(int opcode, bool extended, bool xo) {
+    int x = (opcode >> 8) & 0xf;
+    int n = opcode & 0xf;
+    int kk = opcode & 0xff;
+    switch (opcode >> 12) {
+    case 0x0:
+        if (opcode == 0x00E0) {
+            return Op::Cls;
+        }
+        if (opcode == 0x00EE) {
+            return Op::Ret;
+        }
+        if (extended && x == 0) {
+            switch (kk) {
+            case 0xFB: return Op::ScrollRight;
+            case 0xFC: return Op::ScrollLeft;
+            case 0xFD: return Op::Exit;
+            case 0xFE: return Op::LowRes;
+            case 0xFF: return Op::HighRes;
+            }
+            if ((kk & 0xf0) == 0xC0) {
+                return Op::ScrollDown;
+            }
+            if (xo && (kk & 0xf0) == 0xD0) {
+                return Op::ScrollUp;
+            }
+            return Op::Unknown;
+        }
+        return Op::Sys;
+    case 0x1: return Op::Jump;
+    case 0x2: return Op::Call;
+    case 0x3: return Op::SkipEqImm;
+    case 0x4: return Op::SkipNeImm;
+    case 0x5:
+        switch (n) {
+        case 0x2: return xo ? Op::StoreRange : Op::SkipEqReg;
+        case 0x3: return xo ? Op::LoadRange : Op::SkipEqReg;
+        default: return Op::SkipEqReg;
+        }
+    case 0x6: return Op::LoadImm;
+    case 0x7: return Op::AddImm;
+    case 0x8:
+        switch (n) {
+        case 0x0: return Op::Move;
+        case 0x1: return Op::Or;
+        case 0x2: return Op::And;
+        case 0x3: return Op::Xor;
+        case 0x4: return Op::Add;
+        case 0x5: return Op::Sub;
+        case 0x6: return Op::ShiftRight;
+        case 0x7: return Op::SubReverse;
+        case 0xE: return Op::ShiftLeft;
+        default: return Op::Unknown;
+        }
+    case 0x9: return Op::SkipNeReg;
+    case 0xA: return Op::LoadI;
+    case 0xB: return Op::JumpIndexed;
+    case 0xC: return Op::Rand;
+    case 0xD: return Op::Draw;
+    case 0xE:
+        switch (kk) {
+        case 0x9E: return Op::SkipKey;
+        case 0xA1: return Op::SkipNoKey;
+        default: return Op::Unknown;
+        }
+    default:
+        switch (kk) {
+        case 0x00: return xo && x == 0 ? Op::LoadLongI : Op::Unknown;
+        case 0x01: return xo ? Op::SelectPlanes : Op::Unknown;
+        case 0x07: return Op::GetDelay;
+        case 0x0A: return Op::WaitKey;
+        case 0x15: return Op::SetDelay;
+        case 0x18: return Op::SetSound;
+        case 0x1E: return Op::AddI;
+        case 0x29: return Op::Font;
+        case 0x30: return extended ? Op::BigFont : Op::Unknown;
+        case 0x33: return Op::Bcd;
+        case 0x55: return Op::Store;
+        case 0x65: return Op::Load;
+        case 0x75: return extended ? Op::SaveFlags : Op::Unknown;
+        case 0x85: return extended ? Op::LoadFlags : Op::Unknown;
+        default: return Op::Unknown;
+        }
+    }
+}
+
+} // namespace fakers
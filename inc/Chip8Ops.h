@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "Quirks.h"
+
+namespace fakers
+{
+constexpr int FLAG_REGISTER = 0xf;
+
+// 8xyN with N known at compile time, on any register file indexable as
+// V0-VF. Every engine goes through this so that they agree on the order of
+// effects. With the legacy profile VF is written first and Vx computed from
+// the registers after that, which matters when x or y is F; the other
+// profiles write VF last.
+template <typename Quirks, int N, typename Registers>
+void applyAluOp(Registers&& v, int x, int y) {
+    static_assert((N >= 0x0 && N <= 0x7) || N == 0xe, "8xyN is defined for N = 0-7 and E");
+    constexpr bool WRITES_FLAG = N > 0x3 || (N != 0x0 && Quirks::logicResetsVf);
+    int flag = 0;
+    if constexpr (N == 0x4) {
+        flag = v[x] + v[y] > 0xff ? 1 : 0;
+    } else if constexpr (N == 0x5) {
+        flag = v[x] >= v[y] ? 1 : 0;
+    } else if constexpr (N == 0x6) {
+        flag = (Quirks::shiftUsesVy ? v[y] : v[x]) & 0x1;
+    } else if constexpr (N == 0x7) {
+        flag = v[y] >= v[x] ? 1 : 0;
+    } else if constexpr (N == 0xe) {
+        flag = !!((Quirks::shiftUsesVy ? v[y] : v[x]) & 0x80);
+    }
+    if constexpr (WRITES_FLAG && !Quirks::flagWrittenLast) {
+        v[FLAG_REGISTER] = flag;
+    }
+    uint8_t vx = v[x];
+    uint8_t vy = v[y];
+    if constexpr (N == 0x0) {
+        v[x] = vy;
+    } else if constexpr (N == 0x1) {
+        v[x] = vx | vy;
+    } else if constexpr (N == 0x2) {
+        v[x] = vx & vy;
+    } else if constexpr (N == 0x3) {
+        v[x] = vx ^ vy;
+    } else if constexpr (N == 0x4) {
+        v[x] = vx + vy;
+    } else if constexpr (N == 0x5) {
+        v[x] = vx - vy;
+    } else if constexpr (N == 0x6) {
+        v[x] = (Quirks::shiftUsesVy ? vy : vx) >> 1;
+    } else if constexpr (N == 0x7) {
+        v[x] = vy - vx;
+    } else {
+        v[x] = (Quirks::shiftUsesVy ? vy : vx) << 1;
+    }
+    if constexpr (WRITES_FLAG && Quirks::flagWrittenLast) {
+        v[FLAG_REGISTER] = flag;
+    }
+}
+
+// 8xyN decoded at run time; throws for an N no profile defines.
+template <typename Quirks = LegacyQuirks, typename Registers>
+void applyAlu(Registers&& v, int opcode) {
+    int x = (opcode >> 8) & 0xf;
+    int y = (opcode >> 4) & 0xf;
+    switch (opcode & 0xf) {
+    case 0x0: applyAluOp<Quirks, 0x0>(v, x, y); break;
+    case 0x1: applyAluOp<Quirks, 0x1>(v, x, y); break;
+    case 0x2: applyAluOp<Quirks, 0x2>(v, x, y); break;
+    case 0x3: applyAluOp<Quirks, 0x3>(v, x, y); break;
+    case 0x4: applyAluOp<Quirks, 0x4>(v, x, y); break;
+    case 0x5: applyAluOp<Quirks, 0x5>(v, x, y); break;
+    case 0x6: applyAluOp<Quirks, 0x6>(v, x, y); break;
+    case 0x7: applyAluOp<Quirks, 0x7>(v, x, y); break;
+    case 0xe: applyAluOp<Quirks, 0xe>(v, x, y); break;
+    default:
+        throw std::runtime_error("NOT HANDLED" + std::to_string(opcode));
+    }
+}
+
+} // namespace fakers
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include "FakeChip8.h"
+
+namespace fakers
+{
+struct SchedulerConfig {
+    uint32_t cyclesPerSecond = 700;
+    // Ignore wall time: run frames back to back and derive the timers from
+    // the cycle count alone.
+    bool maxSpeed = false;
+    // Frames the scheduler replays after a host stall before it gives up
+    // on the lost time.
+    uint32_t maxCatchUpFrames = 30;
+};
+
+// Runs cyclesPerSecond / 60 CPU cycles per frame and ticks the delay and
+// sound timers exactly once per frame, i.e. at 60 Hz of emulated time.
+// Fractional cycles per frame are spread so that every 60 frames execute
+// exactly cyclesPerSecond cycles.
+class ClockScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr uint32_t TIMER_HZ = 60;
+
+    explicit ClockScheduler(SchedulerConfig config = {}, Clock::time_point start = Clock::now())
+        : config_(config), epoch_(start), cyclesThisFrame_(cyclesInFrame(0)) {}
+
+    // Runs up to `budget` cycles in slices that end at frame boundaries,
+    // ticking the timers at each boundary. A machine blocked on Fx0A idles
+    // for the rest of its slice. Returns false once the machine halts.
+    template <typename Chip8>
+    bool runCycles(Chip8& chip8, uint64_t budget) {
+        while (budget) {
+            auto slice = static_cast<uint32_t>(std::min<uint64_t>(budget, cyclesThisFrame_ - frameCycle_));
+            auto result = chip8.runCycles(slice);
+            if (result.reason == StopReason::Halted) {
+                account(chip8, result.cycles);
+                return false;
+            }
+            uint32_t spent = result.reason == StopReason::WaitingForKey ? slice : result.cycles;
+            idleCycles_ += spent - result.cycles;
+            account(chip8, spent);
+            budget -= spent;
+        }
+        return true;
+    }
+
+    // Executes the rest of the current frame.
+    template <typename Chip8>
+    bool runFrame(Chip8& chip8) {
+        return runCycles(chip8, cyclesThisFrame_ - frameCycle_);
+    }
+
+    // Runs every frame that is due at `now`. When the host fell behind the
+    // missed frames are replayed back to back, so emulated time stays a
+    // pure function of the frame count. Returns false once the machine halts.
+    template <typename Chip8>
+    bool advance(Chip8& chip8, Clock::time_point now) {
+        if (config_.maxSpeed) {
+            return runFrame(chip8);
+        }
+        uint64_t due = framesAt(now);
+        if (due > frames_ + config_.maxCatchUpFrames) {
+            epoch_ += frameDuration(due - frames_ - config_.maxCatchUpFrames);
+            due = frames_ + config_.maxCatchUpFrames;
+        }
+        while (frames_ < due) {
+            if (!runFrame(chip8)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Restarts wall-clock pacing with the next frame due one frame after
+    // `now`. For a host that slept while the machine was blocked on Fx0A:
+    // frames in which nothing could happen are not replayed on waking.
+    void resume(Clock::time_point now) {
+        epoch_ = now - frameDuration(frames_);
+    }
+
+    Clock::time_point nextFrameAt() const {
+        return epoch_ + frameDuration(frames_ + 1);
+    }
+
+    // Every cycle run, including the ones idled on Fx0A.
+    uint64_t cycles() const { return cycles_; }
+    // Cycles idled on Fx0A; cycles() - idleCycles() instructions executed.
+    uint64_t idleCycles() const { return idleCycles_; }
+    uint64_t frames() const { return frames_; }
+
+private:
+    template <typename Chip8>
+    void account(Chip8& chip8, uint32_t cycles) {
+        cycles_ += cycles;
+        frameCycle_ += cycles;
+        if (frameCycle_ == cyclesThisFrame_) {
+            chip8.tickTimers();
+            ++frames_;
+            frameCycle_ = 0;
+            cyclesThisFrame_ = cyclesInFrame(frames_);
+        }
+    }
+
+    uint32_t cyclesInFrame(uint64_t frame) const {
+        uint64_t cps = config_.cyclesPerSecond;
+        auto cycles = static_cast<uint32_t>((frame + 1) * cps / TIMER_HZ - frame * cps / TIMER_HZ);
+        return std::max<uint32_t>(cycles, 1);
+    }
+
+    uint64_t framesAt(Clock::time_point now) const {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - epoch_).count();
+        return elapsed > 0 ? static_cast<uint64_t>(elapsed) * TIMER_HZ / 1'000'000'000 : 0;
+    }
+
+    static Clock::duration frameDuration(uint64_t frames) {
+        return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::nanoseconds{ frames * 1'000'000'000 / TIMER_HZ });
+    }
+
+    SchedulerConfig config_;
+    Clock::time_point epoch_;
+    uint64_t cycles_ = 0;
+    uint64_t idleCycles_ = 0;
+    uint64_t frames_ = 0;
+    uint32_t frameCycle_ = 0;
+    uint32_t cyclesThisFrame_;
+};
+
+} // namespace fakers
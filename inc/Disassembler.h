@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Chip8Decode.h"
+
+namespace fakers
+{
+struct Instruction {
+    int address;
+    int opcode;
+    Op op;
+    // The word after F000, otherwise 0.
+    int longWord;
+};
+
+enum class EdgeKind {
+    FallThrough,
+    // The path past a skipped instruction.
+    Skip,
+    Jump,
+    Call,
+};
+
+struct Edge {
+    int target;
+    EdgeKind kind;
+};
+
+// A maximal straight-line run: entered only at `start`, left only after its
+// last instruction.
+struct BasicBlock {
+    int start;
+    int end;
+    std::vector<Edge> successors;
+};
+
+// What recursive descent from the entry point found. Addresses are machine
+// addresses; the program sits at MEM_START.
+struct Disassembly {
+    int programStart;
+    int programEnd;
+    std::map<int, Instruction> instructions;
+    std::map<int, BasicBlock> blocks;
+    std::set<int> callTargets;
+    // Bnnn sites, whose targets only a run can tell.
+    std::set<int> indirectJumps;
+    // Reachable addresses that do not hold a valid instruction.
+    std::set<int> invalid;
+    // Jump and call targets outside the program.
+    std::set<int> external;
+
+    bool isCode(int address) const;
+};
+
+// Follows every fall-through, skip, jump and call from MEM_START over the
+// program as decodeOp() sees it on the given machine; bytes never reached
+// are data. Each path stops at a return, an exit, a Bnnn or an invalid
+// instruction.
+Disassembly disassemble(uint8_t const* program, size_t size, bool extended, bool xo);
+
+// The instruction in the trace listing's vocabulary, e.g. "asgn V1=0x20".
+std::string formatInstruction(Instruction const& instruction);
+
+} // namespace fakers
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ClockScheduler.h"
+#include "FakeChip8.h"
+#include "RomLibrary.h"
+#include "ScriptedInput.h"
+
+namespace fakers
+{
+struct FarmConfig {
+    unsigned threads = std::thread::hardware_concurrency();
+    uint32_t cyclesPerSecond = SchedulerConfig{}.cyclesPerSecond;
+    Engine engine = Engine::Interpreter;
+};
+
+struct FarmJob {
+    std::string name;
+    // Owned by a RomLibrary that outlives the run.
+    RomEntry const* rom = nullptr;
+    std::vector<KeyEvent> input;
+    uint64_t cycles = 0;
+    // Cxkk seed of the job's machine.
+    uint64_t seed = DEFAULT_SEED;
+};
+
+struct FarmResult {
+    uint64_t cycles = 0;
+    // Of `cycles`, idled on Fx0A.
+    uint64_t idleCycles = 0;
+    bool halted = false;
+    std::string error;
+    // StateHash over pc, I and V0-VF.
+    uint64_t registerHash = 0;
+    Framebuffer framebuffer{};
+    std::chrono::nanoseconds wallTime{};
+};
+
+struct FarmReport {
+    std::vector<FarmResult> results;
+    std::chrono::nanoseconds wallTime{};
+    uint64_t steals = 0;
+
+    uint64_t totalCycles() const;
+    // Executed, i.e. without the idle cycles.
+    uint64_t totalInstructions() const;
+    double instructionsPerSecond() const;
+};
+
+// Runs many independent headless machines across a work-stealing pool. Each
+// job gets its own FakeChip8, scripted input and cycle-derived timers, so the
+// results depend only on the job and not on scheduling.
+class EmulatorFarm {
+public:
+    explicit EmulatorFarm(FarmConfig config = {}) : config_(config) {}
+
+    FarmReport run(std::vector<FarmJob> const& jobs) const;
+    FarmResult runJob(FarmJob const& job) const;
+
+private:
+    FarmConfig config_;
+};
+
+} // namespace fakers
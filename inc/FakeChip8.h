@@ -1,13 +1,29 @@
 #pragma once
 
+#include <array>
 #include <bitset>
-#include <sstream>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
+#include "MachineState.h"
+#include "Profile.h"
+#include "Quirks.h"
+#include "TraceRecord.h"
+
 namespace fakers
 {
 struct DisplayIO {
-    virtual void draw(std::vector<uint64_t> const& graphic) {};
+    virtual void draw(Framebuffer const& /*graphic*/) {};
+    // Called at most once per host frame with the rows (bit n = row n) that
+    // changed since the previous call. Displays that redraw everything can
+    // keep implementing draw() only.
+    virtual void update(Framebuffer const& graphic, uint32_t /*dirtyRows*/) { draw(graphic); }
+    // SUPER-CHIP and XO-CHIP machines: one 128x64 framebuffer per plane,
+    // bit n of dirtyRows = row n of any plane.
+    virtual void updateHiRes(HiResFramebuffer const* /*planes*/, size_t /*planeCount*/, uint64_t /*dirtyRows*/) {}
     virtual ~DisplayIO() {}
 };
 
@@ -17,50 +33,330 @@ struct AudioIO {
 
 struct InputIO {
     virtual std::bitset<16> read() = 0;
+    // Blocks until a key is down or `deadline` passes and returns whether
+    // one is. Sources that cannot wait answer at once.
+    virtual bool waitForKey(std::chrono::steady_clock::time_point /*deadline*/) { return read().any(); }
+};
+
+// Instrumentation policies. The core is instantiated with one of them, so a
+// NoTrace build carries no trace or profiling code at all in the interpreter
+// loop.
+struct NoTrace {
+    static constexpr bool enabled = false;
+    static constexpr bool profiled = false;
+};
+
+struct BinaryTrace {
+    static constexpr bool enabled = true;
+    static constexpr bool profiled = false;
+};
+
+// Counts instructions, Fx0A waits and draws into a ProfileCounters.
+struct Profiling {
+    static constexpr bool enabled = false;
+    static constexpr bool profiled = true;
+};
+
+enum class StopReason {
+    BudgetExhausted,
+    WaitingForKey,
+    Drew,
+    Halted,
+    PredicateMet,
 };
 
-class FakeChip8 {
+struct RunResult {
+    StopReason reason;
+    uint32_t cycles;
+};
+
+enum class Engine {
+    Interpreter,
+    // Decodes straight-line runs into cached blocks of pre-decoded ops and
+    // runs each block in one dispatch.
+    CachedBlocks,
+};
+
+enum class Machine {
+    Chip8,
+    SuperChip,
+    XoChip,
+};
+
+template <typename Trace, typename Model = Chip8Model, typename Quirks = typename DefaultQuirks<Model>::type>
+class BasicFakeChip8 {
 public:
-    ~FakeChip8();
-    void load(const std::vector<uint8_t>& program);
+    using State = BasicMachineState<Model>;
+
+    explicit BasicFakeChip8(Engine engine = Engine::Interpreter);
+
+    // Copies the program to 0x200 with one memcpy; throws if it does not
+    // fit in the model's memory.
+    void load(uint8_t const* program, size_t size);
+    void load(const std::vector<uint8_t>& program) { load(program.data(), program.size()); }
+    // Seeds Cxkk's generator, now and on every later load().
+    void seed(uint64_t seed);
 
     void attachDisplay(DisplayIO* display);
     void attachIO(InputIO* inputIO);
+    void attachTraceSink(TraceSink* sink);
+    // Profiling builds count into `profile` from now on; other builds
+    // ignore it.
+    void attachProfile(ProfileCounters* profile);
 
     void stop();
     bool step();
+    // Executes up to `budget` instructions with the input sampled once for
+    // the whole slice. Returns early after a draw, on Fx0A or on halt.
+    RunResult runCycles(uint32_t budget);
+    // Like runCycles, but also stops once predicate() returns true after an
+    // instruction; with the block engine, after a block.
+    template <typename Predicate>
+    RunResult runUntil(Predicate&& predicate, uint32_t budget);
+    // Decrements the delay and sound timers; call at 60 Hz.
+    void tickTimers();
+    // Publishes the rows drawn since the last call to the display, if any;
+    // call once per host frame.
+    void presentFrame();
+    bool frameDirty() const { return dirtyRows_ != 0; }
+    // Waiting on Fx0A with both timers at zero: nothing observable changes
+    // until a key goes down, so the host may sleep instead of running frames.
+    bool blockedOnKey() const {
+        return state_.waitingForKey && state_.delayTimer == 0 && state_.soundTimer == 0;
+    }
+    bool hiRes() const { return state_.hiRes; }
+
+    int pc() const { return state_.pc; }
+    int regI() const { return state_.regI; }
+    std::array<uint8_t, REGISTER_COUNT> const& registers() const { return state_.v; }
+    std::array<uint8_t, Model::MEMORY> const& memory() const { return state_.memory; }
+    typename Model::Display const& display() const { return state_.display; }
+    State const& state() const { return state_; }
+    // Replaces the whole machine state, e.g. with a snapshot or a rewind
+    // point, and forgets any code decoded from the old memory.
+    void restore(State const& state);
 
 private:
+    static constexpr bool TRACE = Trace::enabled;
+    static constexpr bool PROFILE = Trace::profiled;
+
+    using OpHandler = void (BasicFakeChip8::*)(int opcode);
+    static const OpHandler OP_HANDLERS[16];
+
+    void opSystem(int opcode);
+    void opJump(int opcode);
+    void opCall(int opcode);
+    void opSkipEqImm(int opcode);
+    void opSkipNeImm(int opcode);
+    void opSkipEqReg(int opcode);
+    void opLoadImm(int opcode);
+    void opAddImm(int opcode);
+    void opAlu(int opcode);
+    void opSkipNeReg(int opcode);
+    void opLoadI(int opcode);
+    void opJumpV0(int opcode);
+    void opRand(int opcode);
+    void opDraw(int opcode);
+    void opKey(int opcode);
+    void opMisc(int opcode);
+    void opExtendedSystem(int opcode);
+    void opRegisterRange(int opcode);
+    void drawHiRes(int x, int y, int n);
+    void skipNext();
+    // Fx55 / Fx65 leave I as the quirk profile says.
+    void advanceIndex(int x);
+    // Calls f(plane, index) for each plane selected by Fn01.
+    template <typename F>
+    void forEachPlane(F&& f);
+
+    static constexpr size_t MAX_BLOCK_OPS = 32;
+
+    struct MicroOp {
+        uint16_t opcode;
+        Op op;
+        bool skip;
+    };
+
+    // The ops are stored inline, so decoding never allocates.
+    struct Block {
+        int start;
+        uint32_t count;
+        std::array<MicroOp, MAX_BLOCK_OPS> ops;
+    };
+
+    void execute();
+    struct Never {
+        bool operator()() const { return false; }
+    };
+
+    // Runs the block at pc and, if `chain`, the ones after it until one
+    // draws, waits for a key or halts. Runs at most `budget` ops and returns
+    // how many ran.
+    uint32_t runBlocks(uint32_t budget, bool chain);
+    // Only the last op of a block can jump, wait, draw or halt.
+    uint32_t runBlock(Block const& block, uint32_t budget);
+    uint32_t interpretPage(uint32_t budget);
+    uint16_t decodeBlock(int address);
+    void invalidateCode(size_t address, size_t length);
+    void resetBlockCache();
+    bool running() const;
     constexpr int arg(int opcode, int n) const;
-    void handleStep();
     bool handleGetKey();
     int readOpCode();
-    void flushDebugToStdout();
+    uint8_t& memoryAt(size_t address);
+    void traceInstruction(int pc, int opcode);
+    void profileInstruction(int pc, int opcode);
+    void profileKeyWait(uint64_t cycles);
 
-    bool debug_{};
-
-    std::stringstream debugPrint_;
+    TraceSink* traceSink_{ nullptr };
+    ProfileCounters* profile_{ nullptr };
+    // Where the last Dxyn drew, in pixels of the current resolution; traced
+    // builds only, since Dxyn may overwrite Vx or Vy with the flag.
+    uint8_t drawX_ = 0;
+    uint8_t drawY_ = 0;
 
     bool toStop_ = false;
-    int pc_ = 0;
-    int regI_ = 0;
-    int timer_ = 0;
-    int sound_ = 0;
-
-    int blockKeyVar_ = 0;
-    bool pendingKeyRead_ = false;
+    bool drew_ = false;
+    // Framebuffer rows changed since the last presentFrame(), bit n = row n.
+    uint64_t dirtyRows_ = 0;
 
-
-    std::vector<uint8_t> vars_;
-    std::vector<uint8_t> memory_;
-    std::vector<uint64_t> rawDisplay_;
+    State state_;
+    uint64_t seed_ = DEFAULT_SEED;
 
     std::bitset<16> keyStates_;
 
-    std::vector<int> stack_;
-
     DisplayIO* display_{ nullptr };
     InputIO* inputIO_{ nullptr };
+
+    Engine engine_;
+    // Allocated once; when every block is in use the cache starts over.
+    std::vector<Block> blockPool_;
+    size_t usedBlocks_ = 0;
+    // 1 + the pool index of the block starting at each address, 0 for none.
+    std::vector<uint16_t> blockAt_;
+    // Per code page: whether a cached block covers it, and how often a store
+    // overwrote code in it.
+    std::vector<uint8_t> pageHasCode_;
+    std::vector<uint8_t> pageRewrites_;
 };
 
+template <typename Trace, typename Model, typename Quirks>
+template <typename Predicate>
+RunResult BasicFakeChip8<Trace, Model, Quirks>::runUntil(Predicate&& predicate, uint32_t budget) {
+    if (handleGetKey()) {
+        if constexpr (PROFILE) profileKeyWait(budget);
+        return { toStop_ ? StopReason::Halted : StopReason::WaitingForKey, 0 };
+    }
+    if (engine_ == Engine::CachedBlocks) {
+        // Without a predicate to check, blocks run back to back.
+        constexpr bool CHAIN = std::is_same_v<std::decay_t<Predicate>, Never>;
+        for (uint32_t cycles = 0; cycles < budget;) {
+            cycles += runBlocks(budget - cycles, CHAIN);
+            if (!running()) {
+                return { StopReason::Halted, cycles };
+            }
+            if (state_.waitingForKey) {
+                if constexpr (PROFILE) profileKeyWait(budget - cycles);
+                return { StopReason::WaitingForKey, cycles };
+            }
+            if (drew_) {
+                drew_ = false;
+                return { StopReason::Drew, cycles };
+            }
+            if (predicate()) {
+                return { StopReason::PredicateMet, cycles };
+            }
+        }
+        return { StopReason::BudgetExhausted, budget };
+    }
+    for (uint32_t cycles = 1; cycles <= budget; ++cycles) {
+        execute();
+        if (!running()) {
+            return { StopReason::Halted, cycles };
+        }
+        if (state_.waitingForKey) {
+            if constexpr (PROFILE) profileKeyWait(budget - cycles);
+            return { StopReason::WaitingForKey, cycles };
+        }
+        if (drew_) {
+            drew_ = false;
+            return { StopReason::Drew, cycles };
+        }
+        if (predicate()) {
+            return { StopReason::PredicateMet, cycles };
+        }
+    }
+    return { StopReason::BudgetExhausted, budget };
+}
+
+using FakeChip8 = BasicFakeChip8<NoTrace>;
+using TracedFakeChip8 = BasicFakeChip8<BinaryTrace>;
+using SuperChip8 = BasicFakeChip8<NoTrace, SuperChipModel>;
+using TracedSuperChip8 = BasicFakeChip8<BinaryTrace, SuperChipModel>;
+using XoChip8 = BasicFakeChip8<NoTrace, XoChipModel>;
+using TracedXoChip8 = BasicFakeChip8<BinaryTrace, XoChipModel>;
+using ProfiledFakeChip8 = BasicFakeChip8<Profiling>;
+
+// The cores built into the library: every profile on plain CHIP-8, and
+// SUPER-CHIP and XO-CHIP with their own.
+extern template class BasicFakeChip8<NoTrace, Chip8Model, LegacyQuirks>;
+extern template class BasicFakeChip8<NoTrace, Chip8Model, CosmacVipQuirks>;
+extern template class BasicFakeChip8<NoTrace, Chip8Model, Chip48Quirks>;
+extern template class BasicFakeChip8<NoTrace, Chip8Model, SuperChipQuirks>;
+extern template class BasicFakeChip8<NoTrace, Chip8Model, XoChipQuirks>;
+extern template class BasicFakeChip8<NoTrace, SuperChipModel, SuperChipQuirks>;
+extern template class BasicFakeChip8<NoTrace, XoChipModel, XoChipQuirks>;
+extern template class BasicFakeChip8<BinaryTrace, Chip8Model, LegacyQuirks>;
+extern template class BasicFakeChip8<BinaryTrace, Chip8Model, CosmacVipQuirks>;
+extern template class BasicFakeChip8<BinaryTrace, Chip8Model, Chip48Quirks>;
+extern template class BasicFakeChip8<BinaryTrace, Chip8Model, SuperChipQuirks>;
+extern template class BasicFakeChip8<BinaryTrace, Chip8Model, XoChipQuirks>;
+extern template class BasicFakeChip8<BinaryTrace, SuperChipModel, SuperChipQuirks>;
+extern template class BasicFakeChip8<BinaryTrace, XoChipModel, XoChipQuirks>;
+extern template class BasicFakeChip8<Profiling, Chip8Model, LegacyQuirks>;
+extern template class BasicFakeChip8<Profiling, Chip8Model, CosmacVipQuirks>;
+extern template class BasicFakeChip8<Profiling, Chip8Model, Chip48Quirks>;
+extern template class BasicFakeChip8<Profiling, Chip8Model, SuperChipQuirks>;
+extern template class BasicFakeChip8<Profiling, Chip8Model, XoChipQuirks>;
+extern template class BasicFakeChip8<Profiling, SuperChipModel, SuperChipQuirks>;
+extern template class BasicFakeChip8<Profiling, XoChipModel, XoChipQuirks>;
+
+template <typename T>
+struct CoreType {
+    using type = T;
+};
+
+// Picks the core for a machine and profile chosen at run time and calls
+// f(CoreType<Core>{}). Throws for a profile the machine is not built with.
+template <typename Trace, typename F>
+decltype(auto) withCore(Machine machine, QuirkProfile quirks, F&& f) {
+    switch (machine) {
+    case Machine::SuperChip:
+        if (quirks != QuirkProfile::Default && quirks != QuirkProfile::SuperChip) {
+            throw std::runtime_error("SUPER-CHIP runs with its own quirks only");
+        }
+        return f(CoreType<BasicFakeChip8<Trace, SuperChipModel>>{});
+    case Machine::XoChip:
+        if (quirks != QuirkProfile::Default && quirks != QuirkProfile::XoChip) {
+            throw std::runtime_error("XO-CHIP runs with its own quirks only");
+        }
+        return f(CoreType<BasicFakeChip8<Trace, XoChipModel>>{});
+    case Machine::Chip8:
+        break;
+    }
+    switch (quirks) {
+    case QuirkProfile::CosmacVip:
+        return f(CoreType<BasicFakeChip8<Trace, Chip8Model, CosmacVipQuirks>>{});
+    case QuirkProfile::Chip48:
+        return f(CoreType<BasicFakeChip8<Trace, Chip8Model, Chip48Quirks>>{});
+    case QuirkProfile::SuperChip:
+        return f(CoreType<BasicFakeChip8<Trace, Chip8Model, SuperChipQuirks>>{});
+    case QuirkProfile::XoChip:
+        return f(CoreType<BasicFakeChip8<Trace, Chip8Model, XoChipQuirks>>{});
+    case QuirkProfile::Default:
+        break;
+    }
+    return f(CoreType<BasicFakeChip8<Trace>>{});
+}
+
 } // namespace fakers
\ No newline at end of file
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "ClockScheduler.h"
+#include "FakeChip8.h"
+#include "ScriptedInput.h"
+#include "StateHash.h"
+
+namespace fakers
+{
+
+struct NullDisplay : DisplayIO {
+    void draw(Framebuffer const& /*graphic*/) override {}
+};
+
+struct NullInput : InputIO {
+    std::bitset<16> read() override { return {}; }
+};
+
+struct HeadlessConfig {
+    uint32_t cyclesPerSecond = SchedulerConfig{}.cyclesPerSecond;
+    Engine engine = Engine::Interpreter;
+    // Record a Checkpoint every N cycles and where the program halts; 0
+    // hashes the final state only.
+    uint64_t checkpointInterval = 0;
+    // Cxkk seed; the same seed replays the same run.
+    uint64_t seed = DEFAULT_SEED;
+    // Start from this state (e.g. a loaded snapshot) instead of a fresh load;
+    // CHIP-8 machines only, like snapshots.
+    std::optional<MachineState> initialState;
+    // Keypad states by cycle, e.g. keyScript() of a recorded run; no keys
+    // are down when empty.
+    std::vector<KeyEvent> input;
+};
+
+struct Checkpoint {
+    uint64_t cycle = 0;
+    // hashState(): registers, memory and framebuffer.
+    uint64_t state = 0;
+    uint64_t display = 0;
+    uint64_t registers = 0;
+    // Spent running up to here since the previous checkpoint.
+    std::chrono::nanoseconds wallTime{};
+};
+
+struct HeadlessReport {
+    // Executed; the rates below are per executed instruction.
+    uint64_t instructions = 0;
+    // Cycles idled on Fx0A; they count towards the cycle budget only.
+    uint64_t idleCycles = 0;
+    std::chrono::nanoseconds wallTime{};
+    bool halted = false;
+    uint64_t finalHash = 0;
+    std::vector<Checkpoint> checkpoints;
+    // Left empty for SUPER-CHIP and XO-CHIP runs.
+    MachineState finalState{};
+
+    double instructionsPerSecond() const {
+        auto seconds = std::chrono::duration<double>(wallTime).count();
+        return seconds > 0 ? instructions / seconds : 0.0;
+    }
+
+    double nsPerInstruction() const {
+        return instructions ? static_cast<double>(wallTime.count()) / instructions : 0.0;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, HeadlessReport const& report) {
+    auto flags = os.flags();
+    os << std::fixed << std::setprecision(2)
+        << "instructions=" << report.instructions
+        << " idle=" << report.idleCycles
+        << " wall=" << std::chrono::duration<double, std::milli>(report.wallTime).count() << "ms"
+        << " ips=" << report.instructionsPerSecond()
+        << " ns/instr=" << report.nsPerInstruction()
+        << " state=" << std::hex << report.finalHash
+        << (report.halted ? " halted" : "");
+    os.flags(flags);
+    return os;
+}
+
+struct NullTraceSink : TraceSink {
+    void record(TraceRecord const& /*record*/) override {}
+};
+
+// Drives FakeChip8::step() back to back, without a window and without pacing.
+// Timers follow the cycle count (SchedulerConfig::maxSpeed). Stops after
+// maxInstructions cycles, idle ones included, or as soon as the program
+// halts.
+class FakeChip8HeadlessRunner {
+public:
+    explicit FakeChip8HeadlessRunner(HeadlessConfig config = {}) : config_(config) {}
+
+    template <typename Chip8 = FakeChip8>
+    HeadlessReport run(const std::vector<uint8_t>& program, uint64_t maxInstructions,
+        TraceSink* traceSink = nullptr, ProfileCounters* profile = nullptr) {
+        NullDisplay display;
+        ScriptedInput input{ config_.input };
+        Chip8 chip8{ config_.engine };
+        chip8.attachDisplay(&display);
+        chip8.attachIO(&input);
+        chip8.attachTraceSink(traceSink);
+        chip8.attachProfile(profile);
+        chip8.seed(config_.seed);
+        chip8.load(program);
+        if constexpr (std::is_same_v<typename Chip8::State, MachineState>) {
+            if (config_.initialState) {
+                chip8.restore(*config_.initialState);
+            }
+        }
+
+        ClockScheduler scheduler{ SchedulerConfig{ config_.cyclesPerSecond, true } };
+        HeadlessReport report;
+        auto start = std::chrono::steady_clock::now();
+        auto lastCheckpoint = start;
+        bool running = true;
+        uint64_t checkpoint = config_.checkpointInterval ? config_.checkpointInterval : UINT64_MAX;
+        while (running && scheduler.cycles() < maxInstructions) {
+            // Slices also end on key changes so that each one lands on its
+            // exact cycle.
+            input.advanceTo(scheduler.cycles());
+            uint64_t end = std::min({ maxInstructions, checkpoint, input.nextChange() });
+            running = scheduler.runCycles(chip8, end - scheduler.cycles());
+            if (!config_.checkpointInterval) {
+                continue;
+            }
+            if (!running || scheduler.cycles() == std::min(checkpoint, maxInstructions)) {
+                auto now = std::chrono::steady_clock::now();
+                report.checkpoints.push_back({ scheduler.cycles(), hashState(chip8), hashDisplay(chip8),
+                    hashRegisters(chip8), now - lastCheckpoint });
+                lastCheckpoint = now;
+            }
+            if (scheduler.cycles() == checkpoint) {
+                checkpoint += config_.checkpointInterval;
+            }
+        }
+        report.wallTime = std::chrono::steady_clock::now() - start;
+        report.halted = !running;
+        report.idleCycles = scheduler.idleCycles();
+        report.instructions = scheduler.cycles() - scheduler.idleCycles();
+        report.finalHash = hashState(chip8);
+        if constexpr (std::is_same_v<typename Chip8::State, MachineState>) {
+            report.finalState = chip8.state();
+        }
+        return report;
+    }
+
+private:
+    HeadlessConfig config_;
+};
+
+} // namespace fakers
@@ -3,6 +3,7 @@
 #include <SFML/Graphics.hpp>
 // #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include <bitset>
 #include <fstream>
 #include <future>
@@ -10,52 +11,183 @@
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
 
+#include "ClockScheduler.h"
 #include "FakeChip8.h"
+#include "KeyEventQueue.h"
+#include "RewindRing.h"
+#include "RomReader.h"
 #include "SfmlGui.h"
 namespace fakers
 {
 
-std::vector<uint8_t> readRom(std::string_view romPath) {
-    std::cout << "Loading " << romPath << '\n';
-    auto f = std::ifstream{ romPath.data(), std::ios::binary};
-    std::ostringstream ss;
-    ss << f.rdbuf();
-    auto const& s = ss.str();
-    return { begin(s), end(s) };
-}
-
 class FakeChip8Runner {
 public:
+    explicit FakeChip8Runner(SchedulerConfig config = {}, Engine engine = Engine::Interpreter,
+        Renderer renderer = Renderer::Rectangles, Machine machine = Machine::Chip8,
+        QuirkProfile quirks = QuirkProfile::Default)
+        : config_(config), engine_(engine), renderer_(renderer), machine_(machine), quirks_(quirks) {}
+
     void run(std::string_view romPath) {
-        using namespace std::chrono_literals;
+        withCore<NoTrace>(machine_, quirks_, [&](auto core) {
+            runAs<typename decltype(core)::type>(romPath, nullptr, nullptr);
+        });
+    }
+
+    // Resume from this state instead of the start of the ROM.
+    void startFrom(MachineState const& state) {
+        initialState_ = state;
+    }
+
+    // Seed for Cxkk; a snapshot passed to startFrom brings its own.
+    void seed(uint64_t seed) {
+        seed_ = seed;
+    }
+
+    // Appends every key event with the cycle it reached the core at; replay
+    // the log with FakeChip8HeadlessRunner.
+    void recordKeysTo(std::vector<KeyTransition>* log) {
+        keyLog_ = log;
+    }
+
+    void runTraced(std::string_view romPath, TraceSink* traceSink) {
+        withCore<BinaryTrace>(machine_, quirks_, [&](auto core) {
+            runAs<typename decltype(core)::type>(romPath, traceSink, nullptr);
+        });
+    }
+
+    // Counts into `profile` until the window closes.
+    void runProfiled(std::string_view romPath, ProfileCounters* profile) {
+        withCore<Profiling>(machine_, quirks_, [&](auto core) {
+            runAs<typename decltype(core)::type>(romPath, nullptr, profile);
+        });
+    }
+
+private:
+    // Upper bound on one park; a closed window wakes it earlier.
+    static constexpr std::chrono::milliseconds KEY_WAIT_TIMEOUT{ 250 };
+    // Display updates at max speed: one per 1/60 s of wall time.
+    static constexpr std::chrono::nanoseconds PRESENT_INTERVAL{ 1'000'000'000 / ClockScheduler::TIMER_HZ };
+
+    template <typename Chip8>
+    void runAs(std::string_view romPath, TraceSink* traceSink, ProfileCounters* profile) {
+        // Large enough (64 KB of XO-CHIP memory) to keep off the stack.
+        auto chip8 = std::make_unique<Chip8>(engine_);
+        chip8->attachTraceSink(traceSink);
+        chip8->attachProfile(profile);
+        if (traceSink) {
+            std::cout << "TRACE ON\n";
+        }
+        runWith(*chip8, romPath);
+    }
 
-        Gui gui;
-        FakeChip8 chip8;
-        gui.onExit([&chip8]() { chip8.stop(); });
+    template <typename Chip8>
+    void runWith(Chip8& chip8, std::string_view romPath) {
+        // Set before stop(), so a rewind that restored a state after the
+        // window closed (which clears the stop) still ends the loop.
+        std::atomic<bool> closed{ false };
+        Gui gui{ renderer_ };
+        gui.onExit([&chip8, &closed]() {
+            closed = true;
+            chip8.stop();
+        });
 
         auto g = std::async(std::launch::async, &Gui::run, &gui);
         chip8.attachDisplay(&gui);
-        chip8.attachIO(&gui);
-        chip8.load(readRom(romPath));
+        auto& keys = gui.keys();
+        keys.recordTo(keyLog_);
+        chip8.attachIO(&keys);
+        chip8.seed(seed_);
+        auto program = readRom(romPath);
+        chip8.load(program);
+        std::cout << "Loading Program... program=" << program.size() << " mem=" << chip8.memory().size() << "\n";
+        if constexpr (std::is_same_v<typename Chip8::State, MachineState>) {
+            if (initialState_) {
+                chip8.restore(*initialState_);
+            }
+        }
 
         try {
-            auto start = std::chrono::steady_clock::now();
-            bool isRunning = true;
-            while (isRunning) {
-                auto end = std::chrono::steady_clock::now();
-                std::chrono::duration<double> elapsed_seconds = end - start;
-                if (elapsed_seconds > 8ms) {
-                    start = end;
-                    isRunning = chip8.step();
+            ClockScheduler scheduler{ config_ };
+            // One display update per host frame, however many frames the
+            // scheduler had to catch up on.
+            // Key events land on frame boundaries, where the headless runner
+            // can replay them on the same cycle.
+            // At max speed frames run back to back without sleeping and the
+            // display is updated at most once per 1/60 s of wall time; the
+            // dirty rows of the skipped frames accumulate.
+            // Every presented frame goes into the rewind history; holding
+            // Backspace steps back one of them per 1/60 s. CHIP-8 only, like
+            // snapshots, and not while recording keys, whose log could no
+            // longer be replayed.
+            keys.deliver(scheduler.cycles());
+            RewindRing history;
+            auto nextPresent = ClockScheduler::Clock::now();
+            while (true) {
+                if constexpr (std::is_same_v<typename Chip8::State, MachineState>) {
+                    if (gui.rewinding() && !keyLog_) {
+                        if (history.size() > 1) {
+                            history.truncate(1);
+                        }
+                        if (!history.empty()) {
+                            chip8.restore(history.restore(0));
+                            chip8.presentFrame();
+                        }
+                        if (closed) {
+                            break;
+                        }
+                        std::this_thread::sleep_for(PRESENT_INTERVAL);
+                        scheduler.resume(ClockScheduler::Clock::now());
+                        keys.deliver(scheduler.cycles());
+                        continue;
+                    }
+                }
+                if (!scheduler.advance(chip8, ClockScheduler::Clock::now())) {
+                    break;
+                }
+                auto now = ClockScheduler::Clock::now();
+                if (!config_.maxSpeed || chip8.blockedOnKey() || now >= nextPresent) {
+                    chip8.presentFrame();
+                    if constexpr (std::is_same_v<typename Chip8::State, MachineState>) {
+                        history.capture(scheduler.frames(), chip8.state());
+                    }
+                    nextPresent = now + PRESENT_INTERVAL;
                 }
-                std::this_thread::sleep_for(7ms);
+                if (!chip8.blockedOnKey()) {
+                    if (!config_.maxSpeed) {
+                        std::this_thread::sleep_until(scheduler.nextFrameAt());
+                    }
+                    keys.deliver(scheduler.cycles());
+                    continue;
+                }
+                // Park until a key event arrives instead of idling through
+                // frames, then run the frame that takes the key at once.
+                keys.waitForKey(ClockScheduler::Clock::now() + KEY_WAIT_TIMEOUT);
+                keys.deliver(scheduler.cycles());
+                if (!scheduler.runFrame(chip8)) {
+                    break;
+                }
+                scheduler.resume(ClockScheduler::Clock::now());
             }
+            chip8.presentFrame();
         } catch (std::exception& e) {
             std::cout << "ERROR:" << e.what() << "\n";
         }
         chip8.stop();
     }
+
+    SchedulerConfig config_;
+    Engine engine_;
+    Renderer renderer_;
+    Machine machine_;
+    QuirkProfile quirks_;
+    uint64_t seed_ = DEFAULT_SEED;
+    std::vector<KeyTransition>* keyLog_ = nullptr;
+    // CHIP-8 only, like snapshots.
+    std::optional<MachineState> initialState_;
 };
 
 } // namesapce fakers
\ No newline at end of file
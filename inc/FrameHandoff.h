@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace fakers
+{
+// Single-producer, single-consumer triple buffer. The producer fills the
+// back slot and publishes it, the consumer takes the newest published slot;
+// neither ever waits for the other, and the consumer simply skips frames it
+// was too slow to see.
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer side: the slot to fill before publish().
+    T& back() { return slots_[back_]; }
+    // Producer side: which of the three slots back() is, for producers that
+    // track what each slot still lacks.
+    size_t backIndex() const { return back_; }
+
+    void publish() {
+        back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Consumer side: swaps in the newest published slot, if there is one.
+    // Returns false when nothing was published since the last call.
+    bool acquire() {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    T const& front() const { return slots_[front_]; }
+
+private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<T, 3> slots_{};
+    // Each slot on its own cache line from the indices' point of view.
+    alignas(64) uint8_t back_ = 0;
+    alignas(64) std::atomic<uint8_t> middle_{ 1 };
+    alignas(64) uint8_t front_ = 2;
+};
+
+} // namespace fakers
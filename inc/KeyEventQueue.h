@@ -0,0 +1,77 @@
+#pragma once
+
+#include <bitset>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <istream>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "FakeChip8.h"
+#include "ScriptedInput.h"
+#include "SpscRing.h"
+
+namespace fakers
+{
+// One key going down or up. `cycle` is the scheduler cycle at which the
+// core first saw it; it is 0 while the transition is still queued.
+struct KeyTransition {
+    uint64_t cycle;
+    uint8_t key;
+    bool pressed;
+};
+
+// Key input from the GUI thread to the emulator thread. Every press and
+// release is queued, so a tap shorter than a frame still reaches the core;
+// the emulator applies them with deliver() between run slices, which keeps
+// the keypad constant while instructions run.
+class KeyEventQueue : public InputIO {
+public:
+    explicit KeyEventQueue(size_t capacity = 256) : events_(capacity) {}
+
+    // GUI thread. Returns false, dropping the transition, if the emulator
+    // fell `capacity` transitions behind.
+    bool push(int key, bool pressed);
+    // GUI thread: releases current and future waits, e.g. once the window
+    // closed.
+    void close();
+
+    // Emulator thread. Applies queued transitions in order and stamps them
+    // with `cycle`. Stops before a key that already changed in this call,
+    // so a press stays visible until the next delivery. Returns how many
+    // were applied.
+    size_t deliver(uint64_t cycle);
+    // Emulator thread: appends every delivered transition to `log`.
+    void recordTo(std::vector<KeyTransition>* log) { log_ = log; }
+    std::bitset<16> read() override { return keys_; }
+    // Blocks until a transition is queued, close() was called or `deadline`
+    // passed; returns whether one is queued.
+    bool waitForKey(std::chrono::steady_clock::time_point deadline) override;
+
+private:
+    bool pending() const { return held_ || !events_.empty(); }
+
+    SpscRing<KeyTransition> events_;
+    std::mutex mutex_;
+    std::condition_variable queued_;
+    bool closed_ = false;
+
+    // Emulator side: the keypad as delivered so far.
+    std::bitset<16> keys_;
+    // Popped but left for the next delivery.
+    std::optional<KeyTransition> held_;
+    std::vector<KeyTransition>* log_ = nullptr;
+};
+
+// Input recordings are text, one `cycle key down|up` line per transition
+// with the key in hex; '#' starts a comment.
+void writeKeyLog(std::ostream& os, std::vector<KeyTransition> const& log);
+// Throws on a malformed line or cycles going backwards.
+std::vector<KeyTransition> readKeyLog(std::istream& is);
+// The keypad state after each recorded cycle, as ScriptedInput replays it.
+std::vector<KeyEvent> keyScript(std::vector<KeyTransition> const& log);
+
+} // namespace fakers
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+#include "FakeChip8.h"
+#include "MachineState.h"
+
+namespace fakers
+{
+// Snapshot of one lane, shaped like FakeChip8's accessors so hashState() and
+// friends work on it.
+struct LaneState {
+    int pc_ = 0;
+    int regI_ = 0;
+    std::array<uint8_t, 16> registers_{};
+    std::array<uint8_t, MEM_SIZE> memory_{};
+    Framebuffer display_{};
+
+    int pc() const { return pc_; }
+    int regI() const { return regI_; }
+    std::array<uint8_t, 16> const& registers() const { return registers_; }
+    std::array<uint8_t, MEM_SIZE> const& memory() const { return memory_; }
+    Framebuffer const& display() const { return display_; }
+};
+
+// Steps N CHIP-8 machines in lockstep with their state stored as arrays per
+// register (structure of arrays). Lanes sharing a pc and opcode form a
+// group; 0x6/0x7/0x8, Annn and the register skips run across the whole
+// group with SIMD, everything else runs lane by lane. Groups are kept from
+// step to step and only rebuilt after a branch may have split or joined
+// them. Opcode
+// semantics follow FakeChip8 (the 8xyN family literally shares applyAlu).
+// Lanes that halt or wait on Fx0A simply drop out of the groups.
+class LockstepChip8 {
+public:
+    // Every lane runs this profile.
+    using Quirks = LegacyQuirks;
+
+    explicit LockstepChip8(size_t lanes);
+
+    void load(const std::vector<uint8_t>& program);
+    void setKeys(size_t lane, std::bitset<16> keys);
+    // Seeds one lane's Cxkk generator, now and on every later load(); a
+    // lane and a FakeChip8 with the same seed draw the same numbers.
+    void seed(size_t lane, uint64_t seed);
+
+    // Advances every live lane by up to `budget` instructions. Halted once
+    // all lanes halted, WaitingForKey when no lane can run.
+    RunResult runCycles(uint32_t budget);
+    void tickTimers();
+
+    size_t lanes() const { return lanes_; }
+    bool halted(size_t lane) const { return halted_[lane]; }
+    LaneState lane(size_t lane) const;
+
+    // Lane-instructions retired by the SIMD and the per-lane paths.
+    uint64_t vectorInstructions() const { return vectorInstructions_; }
+    uint64_t scalarInstructions() const { return scalarInstructions_; }
+
+private:
+    size_t step();
+    void regroup();
+    int fetch(size_t lane, int pc) const;
+    bool isVectorizable(int opcode) const;
+    void executeVector(int opcode, uint8_t const* group);
+    void executeScalar(size_t lane, int opcode);
+    void advancePc(uint8_t const* group, uint8_t const* skip);
+    void markWritten(size_t address, size_t length);
+    uint8_t* laneMemory(size_t lane) { return memory_.data() + lane * MEM_SIZE; }
+    uint8_t const* laneMemory(size_t lane) const { return memory_.data() + lane * MEM_SIZE; }
+
+    size_t lanes_;
+    // Lane count rounded up to the SIMD width; padding lanes stay halted.
+    size_t stride_;
+
+    std::array<std::vector<uint8_t>, 16> v_;
+    std::vector<uint16_t> pc_;
+    std::vector<uint16_t> regI_;
+    std::vector<uint8_t> delay_;
+    std::vector<uint8_t> sound_;
+    std::vector<uint16_t> keys_;
+    std::vector<uint8_t> halted_;
+    std::vector<uint8_t> waiting_;
+    std::vector<uint8_t> waitRegister_;
+    std::vector<uint16_t> stack_;
+    std::vector<uint8_t> sp_;
+    std::vector<uint64_t> seeds_;
+    std::vector<RandomState> random_;
+    std::vector<uint8_t> memory_;
+    std::vector<uint64_t> display_;
+
+    // Live lanes grouped by pc: group g is members_[groupStart_[g]] up to
+    // members_[groupStart_[g + 1]] and, if it has several lanes, the 0xff/0x00
+    // lane mask at masks_[groupMask_[g]]. Valid until regroup_ is set.
+    std::vector<uint32_t> members_;
+    std::vector<uint32_t> groupStart_;
+    std::vector<uint8_t> masks_;
+    std::vector<size_t> groupMask_;
+    size_t groups_ = 0;
+    bool regroup_ = true;
+    // regroup() scratch: group index + 1 by pc, and each lane's group.
+    std::vector<uint32_t> groupAt_;
+    std::vector<uint32_t> groupOf_;
+
+    // Per step scratch: per-lane skip decisions.
+    std::vector<uint8_t> skip_;
+    // 256-byte pages any lane has written since load(); outside of them all
+    // lanes are known to hold identical code.
+    std::bitset<MEM_SIZE / 256> writtenPages_;
+
+    uint64_t vectorInstructions_ = 0;
+    uint64_t scalarInstructions_ = 0;
+};
+
+} // namespace fakers
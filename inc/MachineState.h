@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "Random.h"
+
+namespace fakers
+{
+constexpr size_t MEM_SIZE = 0x1000;
+constexpr size_t MEM_START = 0x200;
+constexpr size_t REGISTER_COUNT = 16;
+constexpr size_t DISPLAY_ROWS = 32;
+constexpr size_t STACK_DEPTH = 16;
+// SUPER-CHIP Fx75/Fx85 user flags.
+constexpr size_t FLAG_COUNT = 16;
+
+// Bits of one display row: a single word up to 64 columns, so the CHIP-8
+// path keeps its one-word rows, and an array of words beyond.
+template <size_t Columns>
+struct RowBits {
+    static_assert(Columns % 64 == 0, "rows are whole 64-bit words");
+    using type = std::array<uint64_t, Columns / 64>;
+};
+
+template <>
+struct RowBits<64> {
+    using type = uint64_t;
+};
+
+// One row per line, bit 63 of the first word is the leftmost pixel.
+template <size_t Columns, size_t Rows>
+using BasicFramebuffer = std::array<typename RowBits<Columns>::type, Rows>;
+
+using Framebuffer = BasicFramebuffer<64, DISPLAY_ROWS>;
+// SUPER-CHIP / XO-CHIP high resolution; low resolution pixels are drawn
+// doubled into it.
+using HiResFramebuffer = BasicFramebuffer<128, 64>;
+
+// What a machine is made of. The core is instantiated per model, so the
+// CHIP-8 build carries none of the extended display code.
+struct Chip8Model {
+    static constexpr size_t MEMORY = MEM_SIZE;
+    static constexpr size_t PLANES = 1;
+    // SUPER-CHIP opcodes: 00Cn, 00FB-00FF, Dxy0, Fx30, Fx75, Fx85.
+    static constexpr bool EXTENDED = false;
+    // XO-CHIP opcodes: 00Dn, 5xy2, 5xy3, F000 nnnn, Fn01.
+    static constexpr bool XO = false;
+    using Display = Framebuffer;
+};
+
+struct SuperChipModel {
+    static constexpr size_t MEMORY = MEM_SIZE;
+    static constexpr size_t PLANES = 1;
+    static constexpr bool EXTENDED = true;
+    static constexpr bool XO = false;
+    using Display = HiResFramebuffer;
+};
+
+struct XoChipModel {
+    static constexpr size_t MEMORY = 0x10000;
+    static constexpr size_t PLANES = 2;
+    static constexpr bool EXTENDED = true;
+    static constexpr bool XO = true;
+    using Display = std::array<HiResFramebuffer, PLANES>;
+};
+
+// Everything a running CHIP-8 program can observe, in one flat block.
+// Copying a machine, resetting it or taking a snapshot is a plain memcpy of
+// this struct; nothing in it lives on the heap.
+template <typename Model>
+struct alignas(64) BasicMachineState {
+    std::array<uint8_t, REGISTER_COUNT> v{};
+    uint16_t pc = 0;
+    uint16_t regI = 0;
+    uint8_t delayTimer = 0;
+    uint8_t soundTimer = 0;
+    uint8_t sp = 0;
+    // Fx0A: register to receive the key while waitingForKey is set.
+    uint8_t keyRegister = 0;
+    bool waitingForKey = false;
+    // 128x64 mode (00FF) instead of doubled 64x32 pixels (00FE).
+    bool hiRes = false;
+    // XO-CHIP Fn01: bit n selects plane n for drawing, clearing and scrolling.
+    uint8_t planeMask = 1;
+    std::array<uint8_t, FLAG_COUNT> flags{};
+    // Cxkk's generator.
+    RandomState random = seedRandom(DEFAULT_SEED);
+    std::array<uint16_t, STACK_DEPTH> stack{};
+    typename Model::Display display{};
+    std::array<uint8_t, Model::MEMORY> memory{};
+};
+
+using MachineState = BasicMachineState<Chip8Model>;
+
+static_assert(std::is_trivially_copyable_v<MachineState>, "MachineState must stay memcpy-able");
+static_assert(std::is_standard_layout_v<MachineState>, "MachineState must stay a plain struct");
+
+} // namespace fakers
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "MachineState.h"
+
+namespace fakers
+{
+constexpr size_t DISPLAY_COLUMNS = 64;
+constexpr size_t HIRES_COLUMNS = 128;
+
+// Packs a colour so that its bytes lie in memory as R, G, B, A, the layout
+// textures expect, whatever the host's endianness.
+inline uint32_t rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 0xff) {
+    uint8_t const bytes[4] = { r, g, b, a };
+    uint32_t pixel;
+    std::memcpy(&pixel, bytes, sizeof(pixel));
+    return pixel;
+}
+
+// Expands framebuffer rows into one 32-bit pixel per CHIP-8 pixel. A table
+// holds the eight pixels of every possible byte, so a row is eight table
+// lookups and eight 32-byte copies.
+class PixelExpander {
+public:
+    // Colours of: no plane, plane 0, plane 1, both planes.
+    using Palette = std::array<uint32_t, 4>;
+
+    explicit PixelExpander(Palette palette) : palette_(palette) {
+        for (size_t byte = 0; byte < spans_.size(); ++byte) {
+            spreads_[byte] = 0;
+            for (size_t bit = 0; bit < 8; ++bit) {
+                bool lit = byte & (0x80 >> bit);
+                spans_[byte][bit] = palette[lit];
+                spreads_[byte] |= static_cast<uint64_t>(lit) << (8 * bit);
+            }
+        }
+    }
+
+    // Writes 64 pixels, leftmost (bit 63) first.
+    void expandRow(uint64_t row, uint32_t* out) const {
+        for (size_t byte = 0; byte < 8; ++byte) {
+            auto const& span = spans_[(row >> (56 - 8 * byte)) & 0xff];
+            std::memcpy(out + 8 * byte, span.data(), sizeof(span));
+        }
+    }
+
+    // Same for two planes: each pixel's colour is picked by its bits in
+    // both, eight pixels at a time with one byte per pixel.
+    void expandRow(uint64_t plane0, uint64_t plane1, uint32_t* out) const {
+        if (!plane1) {
+            expandRow(plane0, out);
+            return;
+        }
+        for (size_t byte = 0; byte < 8; ++byte) {
+            int shift = 56 - 8 * static_cast<int>(byte);
+            uint64_t colours = spreads_[(plane0 >> shift) & 0xff] | spreads_[(plane1 >> shift) & 0xff] << 1;
+            for (size_t bit = 0; bit < 8; ++bit) {
+                out[8 * byte + bit] = palette_[(colours >> (8 * bit)) & 0x3];
+            }
+        }
+    }
+
+private:
+    Palette palette_;
+    std::array<std::array<uint32_t, 8>, 256> spans_;
+    // Byte n of spreads_[b] is bit 7 - n of b.
+    std::array<uint64_t, 256> spreads_;
+};
+
+} // namespace fakers
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "Chip8Decode.h"
+
+namespace fakers
+{
+// What a core built with the Profiling policy counts into an attached
+// ProfileCounters. Plain integers bumped by the interpreter thread; read
+// them once the machine is stopped or between run slices. The interpreter
+// only bumps two array slots per instruction, by raw opcode and by address;
+// instructions, families and ops are derived from the opcode counts when
+// asked for. About 1 MB, so keep it off the stack.
+struct ProfileCounters {
+    static constexpr size_t SLOTS = 0x10000;
+
+    // Executions per raw opcode.
+    std::array<uint64_t, SLOTS> opcodes{};
+    // Executions per instruction address, up to XO-CHIP's 64 KB.
+    std::array<uint64_t, SLOTS> addresses{};
+    // Instructions the budget allowed while the machine waited on Fx0A.
+    uint64_t keyWaitCycles = 0;
+    uint64_t draws = 0;
+    // Draws that set VF.
+    uint64_t collisions = 0;
+    // The machine's opcode set, for decodeOp(); attachProfile() sets them.
+    bool extended = false;
+    bool xo = false;
+
+    void reset();
+    uint64_t instructions() const;
+    // By top nibble of the opcode.
+    std::array<uint64_t, 16> families() const;
+    // By instruction, as decodeOp() tells them apart.
+    std::array<uint64_t, static_cast<size_t>(Op::Count)> ops() const;
+};
+
+// Every counter, with only the ops and addresses that ran.
+void writeProfileJson(std::ostream& os, ProfileCounters const& profile);
+// One `kind,key,count` row per counter.
+void writeProfileCsv(std::ostream& os, ProfileCounters const& profile);
+// JSON for a .json path, CSV otherwise; throws if the file cannot be written.
+void writeProfile(std::string const& path, ProfileCounters const& profile);
+
+} // namespace fakers
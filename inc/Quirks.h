@@ -0,0 +1,114 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#include "MachineState.h"
+#include "SpriteBlit.h"
+
+namespace fakers
+{
+// What Fx55 / Fx65 leave in I.
+enum class IndexIncrement {
+    None,
+    ByX,
+    ByXPlusOne,
+};
+
+// Opcode interpretations that differ between the platforms CHIP-8 programs
+// were written for. The core takes a profile as a template parameter, so a
+// quirk is decided at compile time and costs nothing in the loop.
+struct LegacyQuirks {
+    // 8xy6 / 8xyE shift Vy into Vx instead of shifting Vx in place.
+    static constexpr bool shiftUsesVy = false;
+    // 8xy1 / 8xy2 / 8xy3 clear VF.
+    static constexpr bool logicResetsVf = false;
+    // 8xyN writes VF after Vx, so VF holds the flag even when x is F.
+    static constexpr bool flagWrittenLast = false;
+    static constexpr IndexIncrement loadStoreIncrement = IndexIncrement::None;
+    // Bxnn jumps to xnn + Vx instead of Bnnn to nnn + V0.
+    static constexpr bool jumpUsesVx = false;
+    static constexpr SpriteEdge spriteEdge = SpriteEdge::Clip;
+};
+
+struct CosmacVipQuirks {
+    static constexpr bool shiftUsesVy = true;
+    static constexpr bool logicResetsVf = true;
+    static constexpr bool flagWrittenLast = true;
+    static constexpr IndexIncrement loadStoreIncrement = IndexIncrement::ByXPlusOne;
+    static constexpr bool jumpUsesVx = false;
+    static constexpr SpriteEdge spriteEdge = SpriteEdge::Clip;
+};
+
+struct Chip48Quirks {
+    static constexpr bool shiftUsesVy = false;
+    static constexpr bool logicResetsVf = false;
+    static constexpr bool flagWrittenLast = true;
+    static constexpr IndexIncrement loadStoreIncrement = IndexIncrement::ByX;
+    static constexpr bool jumpUsesVx = true;
+    static constexpr SpriteEdge spriteEdge = SpriteEdge::Clip;
+};
+
+struct SuperChipQuirks {
+    static constexpr bool shiftUsesVy = false;
+    static constexpr bool logicResetsVf = false;
+    static constexpr bool flagWrittenLast = true;
+    static constexpr IndexIncrement loadStoreIncrement = IndexIncrement::None;
+    static constexpr bool jumpUsesVx = true;
+    static constexpr SpriteEdge spriteEdge = SpriteEdge::Clip;
+};
+
+struct XoChipQuirks {
+    static constexpr bool shiftUsesVy = true;
+    static constexpr bool logicResetsVf = false;
+    static constexpr bool flagWrittenLast = true;
+    static constexpr IndexIncrement loadStoreIncrement = IndexIncrement::ByXPlusOne;
+    static constexpr bool jumpUsesVx = false;
+    static constexpr SpriteEdge spriteEdge = SpriteEdge::Wrap;
+};
+
+// The profile a machine runs with unless another one is asked for. Plain
+// CHIP-8 keeps this emulator's historical behaviour.
+template <typename Model>
+struct DefaultQuirks {
+    using type = LegacyQuirks;
+};
+
+template <>
+struct DefaultQuirks<SuperChipModel> {
+    using type = SuperChipQuirks;
+};
+
+template <>
+struct DefaultQuirks<XoChipModel> {
+    using type = XoChipQuirks;
+};
+
+// Run-time names of the profiles, e.g. for the command line.
+enum class QuirkProfile {
+    // The machine's DefaultQuirks.
+    Default,
+    CosmacVip,
+    Chip48,
+    SuperChip,
+    XoChip,
+};
+
+// Profile for a command line name: vip, chip48, schip or xochip.
+inline std::optional<QuirkProfile> quirkProfileNamed(std::string_view name) {
+    if (name == "vip") {
+        return QuirkProfile::CosmacVip;
+    }
+    if (name == "chip48") {
+        return QuirkProfile::Chip48;
+    }
+    if (name == "schip") {
+        return QuirkProfile::SuperChip;
+    }
+    if (name == "xochip") {
+        return QuirkProfile::XoChip;
+    }
+    return std::nullopt;
+}
+
+} // namespace fakers
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace fakers
+{
+// Cxkk seed used when none is given, so runs are reproducible by default.
+constexpr uint64_t DEFAULT_SEED = 0;
+
+// xoshiro256** state. Lives in the machine state, so every instance draws
+// its own sequence, snapshots and rewinds restore it, and the same seed
+// gives the same run on any host or thread.
+struct RandomState {
+    std::array<uint64_t, 4> words;
+};
+
+// Expands a seed into a state with splitmix64, which never yields the
+// all-zero state xoshiro cannot leave.
+constexpr RandomState seedRandom(uint64_t seed) {
+    RandomState state{};
+    for (auto& word : state.words) {
+        seed += 0x9e3779b97f4a7c15ull;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        word = z ^ (z >> 31);
+    }
+    return state;
+}
+
+constexpr uint64_t rotateLeft(uint64_t value, int count) {
+    return (value << count) | (value >> (64 - count));
+}
+
+constexpr uint64_t nextRandom(RandomState& state) {
+    auto& s = state.words;
+    uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+    return result;
+}
+
+// Cxkk's byte: the top bits, which are xoshiro's strongest.
+constexpr uint8_t nextRandomByte(RandomState& state) {
+    return static_cast<uint8_t>(nextRandom(state) >> 56);
+}
+
+} // namespace fakers
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#include "MachineState.h"
+#include "Quirks.h"
+
+namespace fakers
+{
+// Plain CHIP-8 written straight from the opcode table: one switch, pixels
+// drawn one at a time, no handler tables, block cache or SIMD. It shares
+// only MachineState, the quirk profiles and the Cxkk generator with the
+// fast engines, which chip8_fuzz checks against it instruction by
+// instruction.
+template <typename Quirks = LegacyQuirks>
+class ReferenceChip8 {
+public:
+    // Throws like FakeChip8::load() if the program does not fit.
+    void load(uint8_t const* program, size_t size, uint64_t seed = DEFAULT_SEED);
+    // What one FakeChip8::step() does with `keys` held: hands a key to a
+    // pending Fx0A, then runs one instruction unless still waiting. Returns
+    // false once the machine halted. Throws on stack under- and overflow
+    // and on undefined 8xyN.
+    bool step(std::bitset<16> keys);
+    void tickTimers();
+
+    bool halted() const { return halted_ || size_t{ state_.pc } + 1 >= MEM_SIZE; }
+    MachineState const& state() const { return state_; }
+
+private:
+    void execute(int opcode);
+    void alu(int opcode);
+    void draw(int vx, int vy, int n);
+    uint8_t& memoryAt(size_t address) { return state_.memory[address % MEM_SIZE]; }
+
+    MachineState state_;
+    std::bitset<16> keys_;
+    bool halted_ = false;
+};
+
+extern template class ReferenceChip8<LegacyQuirks>;
+extern template class ReferenceChip8<CosmacVipQuirks>;
+extern template class ReferenceChip8<Chip48Quirks>;
+extern template class ReferenceChip8<SuperChipQuirks>;
+extern template class ReferenceChip8<XoChipQuirks>;
+
+} // namespace fakers
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "MachineState.h"
+
+namespace fakers
+{
+struct RewindConfig {
+    // Keep one snapshot every K frames.
+    uint32_t framesPerSnapshot = 1;
+    // Oldest snapshots are dropped beyond this; 3600 frames is a minute.
+    size_t capacity = 3600;
+};
+
+// History of machine states for rewinding. Everything but memory is
+// copied into each entry; memory is split into 256-byte pages that are
+// shared with the previous entry unless they changed, so an entry usually
+// costs a few hundred bytes instead of 4 KB.
+class RewindRing {
+public:
+    static constexpr size_t PAGE_SIZE = 256;
+    static constexpr size_t PAGE_COUNT = MEM_SIZE / PAGE_SIZE;
+
+    explicit RewindRing(RewindConfig config = {}) : config_(config) {}
+
+    // Call once per frame; keeps the state if the frame is due.
+    void capture(uint64_t frame, MachineState const& state);
+
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    // Frame of the snapshot `stepsBack` snapshots before the newest one.
+    uint64_t frame(size_t stepsBack) const;
+    MachineState restore(size_t stepsBack) const;
+    // Drops every snapshot newer than `stepsBack`, e.g. after rewinding.
+    void truncate(size_t stepsBack);
+
+    // Heap bytes held by the entries and their distinct pages.
+    size_t memoryBytes() const;
+
+private:
+    using Page = std::array<uint8_t, PAGE_SIZE>;
+
+    // Every MachineState field but memory, copied one by one.
+    struct Head {
+        std::array<uint8_t, REGISTER_COUNT> v;
+        uint16_t pc;
+        uint16_t regI;
+        uint8_t delayTimer;
+        uint8_t soundTimer;
+        uint8_t sp;
+        uint8_t keyRegister;
+        bool waitingForKey;
+        bool hiRes;
+        uint8_t planeMask;
+        std::array<uint8_t, FLAG_COUNT> flags;
+        RandomState random;
+        std::array<uint16_t, STACK_DEPTH> stack;
+        Chip8Model::Display display;
+    };
+
+    struct Entry {
+        uint64_t frame;
+        Head head;
+        std::array<std::shared_ptr<const Page>, PAGE_COUNT> pages;
+    };
+
+    Entry const& entry(size_t stepsBack) const;
+
+    RewindConfig config_;
+    std::deque<Entry> entries_;
+};
+
+} // namespace fakers
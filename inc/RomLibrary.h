@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MachineState.h"
+
+namespace fakers
+{
+constexpr char ROM_PACK_MAGIC[4] = { 'C', '8', 'R', 'P' };
+constexpr uint32_t ROM_PACK_VERSION = 1;
+// The CHIP-8 program window, 0x200-0xFFF.
+constexpr size_t MAX_PROGRAM_SIZE = MEM_SIZE - MEM_START;
+
+// A whole file mapped read-only; unmapped on destruction.
+class MappedFile {
+public:
+    explicit MappedFile(std::string const& path);
+    ~MappedFile();
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    uint8_t const* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    uint8_t const* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+struct RomEntry {
+    std::string name;
+    // Points into the library's mapping; load() copies it straight into
+    // machine memory.
+    uint8_t const* data = nullptr;
+    size_t size = 0;
+    // FNV-1a of the content, to spot duplicates across a library.
+    uint64_t hash = 0;
+};
+
+struct RejectedRom {
+    std::string name;
+    std::string reason;
+};
+
+// Index of ROMs kept mapped for the library's lifetime. add() takes a single
+// ROM file, a directory (every regular file in it, by name) or a pack
+// written by writeRomPack(). Empty programs and programs larger than
+// maxProgramSize are listed in rejected() instead of entries().
+class RomLibrary {
+public:
+    explicit RomLibrary(size_t maxProgramSize = MAX_PROGRAM_SIZE) : maxProgramSize_(maxProgramSize) {}
+
+    void add(std::string const& path);
+
+    std::vector<RomEntry> const& entries() const { return entries_; }
+    std::vector<RejectedRom> const& rejected() const { return rejected_; }
+    RomEntry const* find(std::string_view name) const;
+
+private:
+    MappedFile const& map(std::string const& path);
+    void addPack(std::string const& path, MappedFile const& file);
+    void addRom(std::string name, uint8_t const* data, size_t size);
+
+    size_t maxProgramSize_;
+    std::vector<std::unique_ptr<MappedFile>> files_;
+    std::vector<RomEntry> entries_;
+    std::vector<RejectedRom> rejected_;
+};
+
+// Writes the entries into one pack file: magic, version and count, then per
+// ROM its offset, size and name, then the programs back to back. All
+// integers are little-endian.
+void writeRomPack(std::string const& path, std::vector<RomEntry> const& entries);
+
+} // namespace fakers
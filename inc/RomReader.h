@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fakers
+{
+
+// Reads a whole ROM file with a single read; RomLibrary maps ROMs instead
+// for batch runs.
+inline std::vector<uint8_t> readRom(std::string_view romPath) {
+    std::cout << "Loading " << romPath << '\n';
+    std::ifstream f{ std::string{ romPath }, std::ios::binary | std::ios::ate };
+    if (!f) {
+        throw std::runtime_error("cannot open ROM " + std::string{ romPath });
+    }
+    std::vector<uint8_t> program(static_cast<size_t>(f.tellg()));
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(program.data()), program.size());
+    return program;
+}
+
+} // namespace fakers
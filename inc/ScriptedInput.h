@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "FakeChip8.h"
+
+namespace fakers
+{
+struct KeyEvent {
+    uint64_t cycle;
+    std::bitset<16> keys;
+};
+
+// InputIO replaying a key-state script: from `cycle` on the keypad reads as
+// `keys`, until the next event. The driver moves it along with advanceTo().
+class ScriptedInput : public InputIO {
+public:
+    explicit ScriptedInput(std::vector<KeyEvent> script) : script_(std::move(script)) {
+        std::stable_sort(begin(script_), end(script_),
+            [](KeyEvent const& a, KeyEvent const& b) { return a.cycle < b.cycle; });
+    }
+
+    void advanceTo(uint64_t cycle) {
+        while (next_ < script_.size() && script_[next_].cycle <= cycle) {
+            keys_ = script_[next_++].keys;
+        }
+    }
+
+    // Cycle of the next key change, or UINT64_MAX when the script is done.
+    uint64_t nextChange() const {
+        return next_ < script_.size() ? script_[next_].cycle : UINT64_MAX;
+    }
+
+    std::bitset<16> read() override { return keys_; }
+
+private:
+    std::vector<KeyEvent> script_;
+    size_t next_ = 0;
+    std::bitset<16> keys_;
+};
+
+} // namespace fakers
@@ -1,39 +1,85 @@
 #pragma once 
 
 #include "FakeChip8.h"
+#include "FrameHandoff.h"
+#include "KeyEventQueue.h"
+#include "PixelExpander.h"
 
 #include <SFML/Graphics.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <bitset>
 #include <fstream>
 #include <future>
 #include <iterator>
 #include <memory>
-#include <mutex>
+#include <tuple>
 namespace fakers
 {
-class Gui : public DisplayIO, public InputIO {
+enum class Renderer {
+    // One outlined rectangle per lit pixel.
+    Rectangles,
+    // The framebuffer as one texture drawn as one scaled sprite.
+    Texture,
+};
+
+// What the render loop draws. CHIP-8 frames fill the top-left 64x32 of
+// plane 0 and leave hiRes unset.
+struct GuiFrame {
+    std::array<HiResFramebuffer, 2> planes{};
+    bool hiRes = false;
+};
+
+class Gui : public DisplayIO {
 public:
+    explicit Gui(Renderer renderer = Renderer::Rectangles);
+
     void run();
 
     void handleKeyPressed(const sf::Event& event, bool isPressed);
 
-    void draw(std::vector<uint64_t> const& graphic) override;
+    void update(Framebuffer const& graphic, uint32_t dirtyRows) override;
+    void updateHiRes(HiResFramebuffer const* planes, size_t planeCount, uint64_t dirtyRows) override;
 
-    virtual std::bitset<16> read() override;
+    // The emulator's input: every press and release from handleKeyPressed,
+    // closed with the window.
+    KeyEventQueue& keys() { return keys_; }
+    // Backspace is held: the emulator steps back through its history.
+    bool rewinding() const { return rewinding_; }
 
     void onExit(std::function<void()>&& handler);
 private:
-    std::mutex drawingMutex_;
-    std::mutex readingKeyMutex_;
+    // Handles window, resize and key events; a resize marks every row in
+    // `resizedRows`.
+    void pollEvents(uint64_t& resizedRows);
+    uint64_t takeStaleRows(uint64_t dirtyRows);
+    void publish(uint64_t dirtyRows);
+    void rebuildRows(GuiFrame const& frame, uint64_t rows);
+    void updateTexture(GuiFrame const& frame, uint64_t rows);
+
+    // Frames go from the emulator thread to the render loop, key events the
+    // other way; neither side takes a lock, so rendering never stalls the
+    // core. Only a core parked on Fx0A sleeps, until the next key event.
+    TripleBuffer<GuiFrame> frames_;
+    // Emulator side: rows each slot lacks. Slots start out blank, like the
+    // display.
+    std::array<uint64_t, 3> staleRows_{};
+    // Rows changed since the render loop last took them.
+    std::atomic<uint64_t> changedRows_{ 0 };
+    KeyEventQueue keys_;
+    std::atomic<bool> rewinding_{ false };
 
     std::unique_ptr<sf::RenderWindow> renderWindow_;
-    std::vector<sf::RectangleShape> pixelRects_;
+    Renderer renderer_;
+    std::array<std::vector<sf::RectangleShape>, std::tuple_size_v<HiResFramebuffer>> rowRects_;
+    PixelExpander expander_;
+    std::array<uint32_t, HIRES_COLUMNS * std::tuple_size_v<HiResFramebuffer>> pixels_;
+    sf::Texture texture_;
     int windowSizeX = 800;
     int windowSizeY = 640;
 
-    std::bitset<16> keyPressedState;
     std::function<void()> onExitHandler;
 };
 
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "MachineState.h"
+
+namespace fakers
+{
+constexpr char SNAPSHOT_MAGIC[4] = { 'C', '8', 'S', 'S' };
+// Version 2 added the Cxkk generator state; version 1 blobs still load.
+constexpr uint32_t SNAPSHOT_VERSION = 2;
+constexpr uint32_t FIRST_SNAPSHOT_VERSION = 1;
+
+// Serializes every field of the machine state, little-endian and field by
+// field, so blobs do not depend on the host's struct layout.
+std::vector<uint8_t> saveSnapshot(MachineState const& state);
+
+// Inverse of saveSnapshot; throws std::runtime_error on a bad magic, an
+// unknown version, a truncated blob or a pc, return address or stack depth
+// the machine could not be in.
+MachineState loadSnapshot(std::vector<uint8_t> const& blob);
+
+void writeSnapshot(std::ostream& os, MachineState const& state);
+MachineState readSnapshot(std::istream& is);
+
+} // namespace fakers
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MachineState.h"
+
+namespace fakers
+{
+// Dxyn draws at most 15 lines, SUPER-CHIP's Dxy0 16 lines of 16 pixels.
+constexpr size_t MAX_SPRITE_LINES = 16;
+
+// What happens to sprite pixels past the right or bottom edge.
+enum class SpriteEdge {
+    Clip,
+    Wrap,
+};
+
+struct BlitResult {
+    bool collision;
+    // Rows whose pixels changed, bit n = row n.
+    uint64_t dirtyRows;
+};
+
+// Reads an 8-pixel-wide sprite of `height` lines into `lines`, leftmost
+// pixel at bit 63, stopping at the end of memory. Returns the line count.
+inline size_t loadSprite(uint8_t const* memory, size_t memorySize, size_t address, size_t height,
+    uint64_t* lines) {
+    size_t count = 0;
+    for (; count < height && address + count < memorySize; ++count) {
+        lines[count] = static_cast<uint64_t>(memory[address + count]) << 56;
+    }
+    return count;
+}
+
+// Reads a SUPER-CHIP 16x16 sprite (two bytes per line) into `lines`.
+inline size_t loadWideSprite(uint8_t const* memory, size_t memorySize, size_t address, uint64_t* lines) {
+    size_t count = 0;
+    for (; count < MAX_SPRITE_LINES && address + 2 * count + 1 < memorySize; ++count) {
+        size_t at = address + 2 * count;
+        lines[count] = static_cast<uint64_t>(memory[at] << 8 | memory[at + 1]) << 48;
+    }
+    return count;
+}
+
+// XORs `count` (at most MAX_SPRITE_LINES) sprite lines into the DISPLAY_ROWS
+// rows at column x, row y. Collision is a single test of all the lines'
+// overlaps ORed together.
+BlitResult blitSprite(uint64_t* rows, uint64_t const* lines, size_t count, unsigned x, unsigned y,
+    SpriteEdge edge);
+
+using HiResRow = HiResFramebuffer::value_type;
+
+// blitSprite for the 128x64 display. Up to 2 * MAX_SPRITE_LINES lines of
+// up to 32 pixels, as low resolution sprites are doubled before drawing.
+BlitResult blitSprite(HiResFramebuffer& rows, uint64_t const* lines, size_t count, unsigned x, unsigned y,
+    SpriteEdge edge);
+
+// Doubles every pixel of a line, for low resolution drawing on the 128x64
+// display: bit 63 - i becomes bits 63 - 2i and 62 - 2i.
+uint64_t doublePixels(uint64_t line);
+
+// SUPER-CHIP / XO-CHIP scrolling; pixels scrolled out are lost.
+void scrollDown(HiResFramebuffer& rows, size_t count);
+void scrollUp(HiResFramebuffer& rows, size_t count);
+void scrollRight(HiResFramebuffer& rows, unsigned count);
+void scrollLeft(HiResFramebuffer& rows, unsigned count);
+
+} // namespace fakers
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace fakers
+{
+// Bounded single-producer/single-consumer queue. push() and pop() never
+// block or lock; the capacity is rounded up to a power of two.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) : slots_(roundUp(capacity)), mask_(slots_.size() - 1) {}
+
+    bool push(T const& value) {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == slots_.size()) {
+            return false;
+        }
+        slots_[head & mask_] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+
+private:
+    static size_t roundUp(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+
+    std::vector<T> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{ 0 };
+    alignas(64) std::atomic<size_t> tail_{ 0 };
+};
+
+} // namespace fakers
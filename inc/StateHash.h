@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace fakers
+{
+// FNV-1a over pc, I, V0-VF, memory and the framebuffer.
+class StateHash {
+public:
+    void add(uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            hash_ = (hash_ ^ ((value >> (8 * i)) & 0xff)) * PRIME;
+        }
+    }
+
+    // Nested containers, such as wide framebuffer rows, are walked down to
+    // their words.
+    template <typename Container>
+    void addAll(Container const& values) {
+        for (auto const& value : values) {
+            if constexpr (std::is_integral_v<std::decay_t<decltype(value)>>) {
+                add(value, sizeof(value));
+            } else {
+                addAll(value);
+            }
+        }
+    }
+
+    uint64_t value() const { return hash_; }
+
+private:
+    static constexpr uint64_t OFFSET = 0xcbf29ce484222325ull;
+    static constexpr uint64_t PRIME = 0x100000001b3ull;
+    uint64_t hash_ = OFFSET;
+};
+
+template <typename Chip8>
+uint64_t hashState(Chip8 const& chip8) {
+    StateHash hash;
+    hash.add(chip8.pc(), 2);
+    hash.add(chip8.regI(), 2);
+    hash.addAll(chip8.registers());
+    hash.addAll(chip8.memory());
+    hash.addAll(chip8.display());
+    return hash.value();
+}
+
+// The framebuffer alone, every plane of it.
+template <typename Chip8>
+uint64_t hashDisplay(Chip8 const& chip8) {
+    StateHash hash;
+    hash.addAll(chip8.display());
+    return hash.value();
+}
+
+// pc, I and V0-VF.
+template <typename Chip8>
+uint64_t hashRegisters(Chip8 const& chip8) {
+    StateHash hash;
+    hash.add(chip8.pc(), 2);
+    hash.add(chip8.regI(), 2);
+    hash.addAll(chip8.registers());
+    return hash.value();
+}
+
+} // namespace fakers
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace fakers
+{
+constexpr uint8_t NO_REGISTER = 0xff;
+
+// One executed instruction. Fixed size, written to trace files as-is.
+struct TraceRecord {
+    uint64_t timestamp;   // ns since the recorder started
+    uint16_t pc;
+    uint16_t opcode;
+    uint16_t regI;        // I after the instruction
+    uint8_t reg;          // Vx written or tested by the instruction, NO_REGISTER if none;
+                          // Dxyn: the sprite's x in pixels
+    uint8_t value;        // value of reg after the instruction; Dxyn: the sprite's y
+};
+static_assert(sizeof(TraceRecord) == 16, "trace records are written to disk verbatim");
+
+struct TraceFileHeader {
+    char magic[4];
+    uint32_t version;
+};
+
+constexpr char TRACE_MAGIC[4] = { 'C', '8', 'T', 'R' };
+constexpr uint32_t TRACE_VERSION = 1;
+
+struct TraceSink {
+    virtual void record(TraceRecord const& record) = 0;
+    virtual ~TraceSink() {}
+};
+
+constexpr uint8_t tracedRegister(int opcode) {
+    switch (opcode >> 12) {
+    case 0x0:
+    case 0x1:
+    case 0x2:
+    case 0xa:
+    case 0xb:
+    case 0xd:
+        return NO_REGISTER;
+    default:
+        return (opcode >> 8) & 0xf;
+    }
+}
+
+// Mnemonic text of a record, in the format the interpreter used to print.
+// nextPc is the pc of the following record, or -1 when it is the last one;
+// it resolves returns and taken skips.
+std::string formatTraceRecord(TraceRecord const& record, int nextPc);
+
+// Reads a whole trace file; throws std::runtime_error on a bad header.
+std::vector<TraceRecord> readTrace(std::istream& is);
+
+} // namespace fakers
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "SpscRing.h"
+#include "TraceRecord.h"
+
+namespace fakers
+{
+// TraceSink that timestamps records, queues them in a lock-free ring and
+// drains them to a binary trace file from a background thread.
+class TraceRecorder : public TraceSink {
+public:
+    explicit TraceRecorder(std::string const& path, size_t capacity = 1 << 16);
+    ~TraceRecorder() override;
+
+    void record(TraceRecord const& record) override;
+    uint64_t recorded() const { return recorded_; }
+
+private:
+    void drain();
+
+    SpscRing<TraceRecord> ring_;
+    std::ofstream out_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t recorded_ = 0;
+    std::atomic<bool> stopping_{ false };
+    std::thread writer_;
+};
+
+} // namespace fakers
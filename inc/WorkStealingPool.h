@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fakers
+{
+// Runs a fixed batch of tasks on N threads. Tasks are dealt round-robin to
+// per-worker deques; a worker pops from the back of its own deque and, once
+// it is empty, steals from the front of the others'. Tasks are expected to be
+// coarse (a whole emulator run), so each deque is guarded by its own mutex.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads)
+        : queues_(threads ? threads : 1) {}
+
+    void run(size_t taskCount, std::function<void(size_t task, unsigned worker)> const& task) {
+        for (size_t i = 0; i < taskCount; ++i) {
+            queues_[i % queues_.size()].tasks.push_back(i);
+        }
+        std::vector<std::thread> workers;
+        for (unsigned worker = 0; worker < queues_.size(); ++worker) {
+            workers.emplace_back([this, worker, &task] { work(worker, task); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    uint64_t steals() const { return steals_; }
+    unsigned threads() const { return static_cast<unsigned>(queues_.size()); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    void work(unsigned worker, std::function<void(size_t, unsigned)> const& task) {
+        size_t next;
+        while (popLocal(worker, next) || steal(worker, next)) {
+            task(next, worker);
+        }
+    }
+
+    bool popLocal(unsigned worker, size_t& task) {
+        auto& queue = queues_[worker];
+        const std::lock_guard lock{ queue.mutex };
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = queue.tasks.back();
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(unsigned thief, size_t& task) {
+        for (size_t i = 1; i < queues_.size(); ++i) {
+            auto& queue = queues_[(thief + i) % queues_.size()];
+            const std::lock_guard lock{ queue.mutex };
+            if (!queue.tasks.empty()) {
+                task = queue.tasks.front();
+                queue.tasks.pop_front();
+                ++steals_;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<Queue> queues_;
+    std::atomic<uint64_t> steals_{ 0 };
+};
+
+} // namespace fakers
@@ -0,0 +1,151 @@
+#include "Disassembler.h"
+
+#include <sstream>
+#include <string_view>
+
+#include "MachineState.h"
+
+namespace fakers
+{
+
+bool Disassembly::isCode(int address) const {
+    auto it = instructions.upper_bound(address);
+    if (it == begin(instructions)) {
+        return false;
+    }
+    --it;
+    return address < it->first + opInfo(it->second.op).length;
+}
+
+Disassembly disassemble(uint8_t const* program, size_t size, bool extended, bool xo) {
+    Disassembly result;
+    result.programStart = MEM_START;
+    result.programEnd = static_cast<int>(MEM_START + size);
+    auto inProgram = [&](int address, int length) {
+        return address >= result.programStart && address + length <= result.programEnd;
+    };
+    auto byteAt = [&](int address) { return program[address - MEM_START]; };
+    auto wordAt = [&](int address) { return byteAt(address) << 8 | byteAt(address + 1); };
+
+    std::map<int, std::vector<Edge>> exits;
+    std::set<int> leaders{ result.programStart };
+    std::vector<int> work{ result.programStart };
+    while (!work.empty()) {
+        int address = work.back();
+        work.pop_back();
+        if (result.instructions.count(address) || result.invalid.count(address)) {
+            continue;
+        }
+        if (!inProgram(address, 2)) {
+            result.invalid.insert(address);
+            continue;
+        }
+        int opcode = wordAt(address);
+        Op op = decodeOp(opcode, extended, xo);
+        auto const& info = opInfo(op);
+        if (op == Op::Unknown || !inProgram(address, info.length)) {
+            result.invalid.insert(address);
+            continue;
+        }
+        result.instructions[address] = { address, opcode, op, info.length == 4 ? wordAt(address + 2) : 0 };
+
+        int next = address + info.length;
+        int nnn = opcode & 0xfff;
+        std::vector<Edge> edges;
+        switch (info.flow) {
+        case Flow::Next:
+            edges.push_back({ next, EdgeKind::FallThrough });
+            break;
+        case Flow::Skip:
+        {
+            // XO-CHIP skips hop over the whole four-byte F000 nnnn.
+            int skipped = xo && inProgram(next, 2) && wordAt(next) == 0xF000 ? 4 : 2;
+            edges.push_back({ next, EdgeKind::FallThrough });
+            edges.push_back({ next + skipped, EdgeKind::Skip });
+            break;
+        }
+        case Flow::Jump:
+            edges.push_back({ nnn, EdgeKind::Jump });
+            break;
+        case Flow::Call:
+            result.callTargets.insert(nnn);
+            edges.push_back({ nnn, EdgeKind::Call });
+            edges.push_back({ next, EdgeKind::FallThrough });
+            break;
+        case Flow::JumpIndexed:
+            result.indirectJumps.insert(address);
+            break;
+        case Flow::Return:
+        case Flow::Exit:
+            break;
+        }
+        auto& kept = exits[address];
+        for (auto const& edge : edges) {
+            if (!inProgram(edge.target, 2)) {
+                // Running off the end of the program is as bad as bad code.
+                auto& into = edge.kind == EdgeKind::Jump || edge.kind == EdgeKind::Call
+                    ? result.external : result.invalid;
+                into.insert(edge.target);
+                continue;
+            }
+            if (info.flow != Flow::Next) {
+                leaders.insert(edge.target);
+            }
+            kept.push_back(edge);
+            work.push_back(edge.target);
+        }
+    }
+
+    // Blocks break at leaders, after anything but a plain fall-through and
+    // wherever the code is not contiguous.
+    BasicBlock* block = nullptr;
+    for (auto const& [address, instruction] : result.instructions) {
+        if (!block || address != block->end || leaders.count(address)) {
+            block = &result.blocks[address];
+            block->start = address;
+        }
+        block->end = address + opInfo(instruction.op).length;
+        block->successors.clear();
+        for (auto const& edge : exits[address]) {
+            if (result.instructions.count(edge.target)) {
+                block->successors.push_back(edge);
+            }
+        }
+        if (opInfo(instruction.op).flow != Flow::Next) {
+            block = nullptr;
+        }
+    }
+    return result;
+}
+
+std::string formatInstruction(Instruction const& instruction) {
+    std::string_view syntax = opInfo(instruction.op).syntax;
+    int opcode = instruction.opcode;
+    std::ostringstream os;
+    os << std::hex;
+    for (size_t i = 0; i < syntax.size(); ++i) {
+        if (syntax[i] != '{') {
+            os << syntax[i];
+            continue;
+        }
+        size_t close = syntax.find('}', i);
+        auto field = syntax.substr(i + 1, close - i - 1);
+        if (field == "x") {
+            os << ((opcode >> 8) & 0xf);
+        } else if (field == "y") {
+            os << ((opcode >> 4) & 0xf);
+        } else if (field == "n") {
+            os << (opcode & 0xf);
+        } else if (field == "kk") {
+            os << (opcode & 0xff);
+        } else if (field == "nnn") {
+            os << (opcode & 0xfff);
+        } else if (field == "long") {
+            os << instruction.longWord;
+        }
+        i = close;
+    }
+    return os.str();
+}
+
+} // namespace fakers
@@ -0,0 +1,80 @@
+#include "EmulatorFarm.h"
+
+#include <algorithm>
+#include <exception>
+
+#include "FakeChip8HeadlessRunner.h"
+#include "StateHash.h"
+#include "WorkStealingPool.h"
+
+namespace fakers
+{
+
+uint64_t FarmReport::totalCycles() const {
+    uint64_t total = 0;
+    for (auto const& result : results) {
+        total += result.cycles;
+    }
+    return total;
+}
+
+uint64_t FarmReport::totalInstructions() const {
+    uint64_t total = 0;
+    for (auto const& result : results) {
+        total += result.cycles - result.idleCycles;
+    }
+    return total;
+}
+
+double FarmReport::instructionsPerSecond() const {
+    auto seconds = std::chrono::duration<double>(wallTime).count();
+    return seconds > 0 ? totalInstructions() / seconds : 0.0;
+}
+
+FarmReport EmulatorFarm::run(std::vector<FarmJob> const& jobs) const {
+    FarmReport report;
+    report.results.resize(jobs.size());
+    WorkStealingPool pool{ config_.threads };
+    auto start = std::chrono::steady_clock::now();
+    pool.run(jobs.size(), [&](size_t job, unsigned) {
+        report.results[job] = runJob(jobs[job]);
+    });
+    report.wallTime = std::chrono::steady_clock::now() - start;
+    report.steals = pool.steals();
+    return report;
+}
+
+FarmResult EmulatorFarm::runJob(FarmJob const& job) const {
+    NullDisplay display;
+    ScriptedInput input{ job.input };
+    FakeChip8 chip8{ config_.engine };
+    chip8.attachDisplay(&display);
+    chip8.attachIO(&input);
+    chip8.seed(job.seed);
+
+    FarmResult result;
+    auto start = std::chrono::steady_clock::now();
+    ClockScheduler scheduler{ SchedulerConfig{ config_.cyclesPerSecond, true } };
+    try {
+        chip8.load(job.rom->data, job.rom->size);
+        bool running = true;
+        while (running && scheduler.cycles() < job.cycles) {
+            // Slices end on key changes so that each one lands on its exact cycle.
+            input.advanceTo(scheduler.cycles());
+            uint64_t sliceEnd = std::min(job.cycles, input.nextChange());
+            running = scheduler.runCycles(chip8, sliceEnd - scheduler.cycles());
+        }
+        result.halted = !running;
+    } catch (std::exception& e) {
+        result.error = e.what();
+    }
+    result.wallTime = std::chrono::steady_clock::now() - start;
+    result.cycles = scheduler.cycles();
+    result.idleCycles = scheduler.idleCycles();
+
+    result.registerHash = hashRegisters(chip8);
+    result.framebuffer = chip8.display();
+    return result;
+}
+
+} // namespace fakers
@@ -1,12 +1,15 @@
-#pragma once
-
 #include "FakeChip8.h"
 
+#include "Chip8Decode.h"
+#include "Chip8Ops.h"
+#include "SpriteBlit.h"
+
+#include <algorithm>
 #include <bitset>
-#include <iostream>
-#include <functional>
-#include <sstream>
-#include <unordered_map>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <tuple>
 #include <vector>
 
 namespace fakers
@@ -33,360 +36,776 @@ constexpr unsigned char CHIP8_FONT_SET[80] =
     0xF0, 0x80, 0xF0, 0x80, 0x80  //F
 };
 
-static constexpr size_t MEM_SIZE = 0x1000;
-static constexpr size_t MEM_START = 0x200;
-static constexpr size_t FLAG_REG = 0xf;
+// SUPER-CHIP 8x10 digits for Fx30, loaded right after the small ones.
+constexpr unsigned char BIG_FONT_SET[160] =
+{
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, //0
+    0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, //1
+    0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, //2
+    0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, //3
+    0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, //4
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, //5
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, //6
+    0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18, //7
+    0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, //8
+    0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, //9
+    0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, //A
+    0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, //B
+    0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C, //C
+    0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC, //D
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, //E
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0  //F
+};
+constexpr size_t BIG_FONT_START = sizeof(CHIP8_FONT_SET);
 
-constexpr bool ENABLE_DEBUGGING = true;
+static constexpr size_t FLAG_REG = 0xf;
+static constexpr uint64_t ALL_ROWS = ~0ull;
+static_assert(std::tuple_size_v<HiResFramebuffer> <= 64, "dirty rows are tracked in a 64-bit mask");
+static constexpr size_t CODE_PAGE_SHIFT = 6;
+static constexpr size_t CODE_PAGE_SIZE = size_t{ 1 } << CODE_PAGE_SHIFT;
+static constexpr size_t BLOCK_POOL_SIZE = 512;
+// A page whose code was overwritten this often is rewritten as it runs,
+// e.g. by a loop patching itself, and is interpreted from then on.
+static constexpr uint8_t SELF_MODIFYING_REWRITES = 16;
 
 } // namespace
 
-FakeChip8::~FakeChip8() {
-    flushDebugToStdout();
+template <typename Trace, typename Model, typename Quirks>
+BasicFakeChip8<Trace, Model, Quirks>::BasicFakeChip8(Engine engine) : engine_(engine) {}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::load(uint8_t const* program, size_t size) {
+    if (size > Model::MEMORY - MEM_START) {
+        throw std::runtime_error("program does not fit in memory: " + std::to_string(size));
+    }
+    state_ = State{};
+    state_.pc = MEM_START;
+    state_.random = seedRandom(seed_);
+    dirtyRows_ = ALL_ROWS;
+    std::copy(std::begin(CHIP8_FONT_SET), std::end(CHIP8_FONT_SET), std::begin(state_.memory));
+    if constexpr (Model::EXTENDED) {
+        std::copy(std::begin(BIG_FONT_SET), std::end(BIG_FONT_SET), std::begin(state_.memory) + BIG_FONT_START);
+    }
+    if (size) {
+        std::memcpy(state_.memory.data() + MEM_START, program, size);
+    }
+    resetBlockCache();
 }
 
-void FakeChip8::load(const std::vector<uint8_t>& program) {
-    std::cout << "Loading Program... ";
-    vars_.resize(16);
-    memory_.resize(MEM_SIZE);
-    rawDisplay_.resize(32);
-    std::fill(begin(rawDisplay_), end(rawDisplay_), 0x00);
-    pc_ = MEM_START;
-    std::copy(std::begin(CHIP8_FONT_SET), std::end(CHIP8_FONT_SET), std::begin(memory_));
-    std::copy(std::begin(program), std::end(program), std::begin(memory_) + MEM_START);
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::seed(uint64_t seed) {
+    seed_ = seed;
+    state_.random = seedRandom(seed);
+}
 
-    std::cout << "program=" << program.size() << " mem=" << memory_.size() << "\n";
-    debug_ = ENABLE_DEBUGGING;
-    if (debug_) {
-        std::cout << "DEBUG ON";
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::restore(State const& state) {
+    state_ = state;
+    toStop_ = false;
+    drew_ = false;
+    dirtyRows_ = ALL_ROWS;
+    resetBlockCache();
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::resetBlockCache() {
+    static_assert(2 * MAX_BLOCK_OPS <= CODE_PAGE_SIZE, "a block covers at most two pages");
+    if (engine_ == Engine::CachedBlocks) {
+        blockPool_.resize(BLOCK_POOL_SIZE);
+        usedBlocks_ = 0;
+        blockAt_.assign(Model::MEMORY, 0);
+        pageHasCode_.assign(Model::MEMORY / CODE_PAGE_SIZE, 0);
+        pageRewrites_.assign(Model::MEMORY / CODE_PAGE_SIZE, 0);
     }
 }
 
-void FakeChip8::attachDisplay(DisplayIO* display) {
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::attachDisplay(DisplayIO* display) {
     display_ = display;
 }
 
-void FakeChip8::attachIO(InputIO* inputIO) {
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::attachIO(InputIO* inputIO) {
     inputIO_ = inputIO;
 }
 
-void FakeChip8::stop() {
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::attachTraceSink(TraceSink* sink) {
+    traceSink_ = sink;
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::attachProfile(ProfileCounters* profile) {
+    static_assert(Model::MEMORY <= ProfileCounters::SLOTS, "every address has a counter");
+    profile_ = profile;
+    if (profile_) {
+        profile_->extended = Model::EXTENDED;
+        profile_->xo = Model::XO;
+    }
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::stop() {
     toStop_ = true;
 }
 
-bool FakeChip8::step() {
-    handleStep();
+template <typename Trace, typename Model, typename Quirks>
+bool BasicFakeChip8<Trace, Model, Quirks>::step() {
     if (handleGetKey()) {
+        if constexpr (PROFILE) profileKeyWait(1);
         return !toStop_;
     }
+    if (engine_ == Engine::CachedBlocks) {
+        runBlocks(1, false);
+    } else {
+        execute();
+    }
+    drew_ = false;
+    return running();
+}
 
-    debugPrint_.str("");
-    if (debug_) debugPrint_ << "0x" << std::hex << pc_ << "\t0x";
+template <typename Trace, typename Model, typename Quirks>
+RunResult BasicFakeChip8<Trace, Model, Quirks>::runCycles(uint32_t budget) {
+    return runUntil(Never{}, budget);
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::execute() {
+    int pc = state_.pc;
     int opcode = readOpCode();
-    if (debug_) debugPrint_ << std::hex << opcode << ":\t";
-    auto calls = std::unordered_map<int, std::function<int(int)>>{ {
-        { 0, [&](int opcode) {
-        if (opcode == 0x00E0) {
-            if (debug_) debugPrint_ << "cls";
-            rawDisplay_.clear();
-            rawDisplay_.resize(32);
-            return 0;
-        }
-        if (opcode == 0x00EE) {
-            pc_ = stack_.back();
-            if (debug_) debugPrint_ << "ret  pc=0x" << std::hex << pc_;
-            stack_.pop_back();
-            return 0;
-        }
-        pc_ = opcode & 0xfff;
-        if (debug_) debugPrint_ << "exec pc=0x" << std::hex << pc_;
+    (this->*OP_HANDLERS[arg(opcode, 0)])(opcode);
+    if constexpr (TRACE) traceInstruction(pc, opcode);
+    if constexpr (PROFILE) profileInstruction(pc, opcode);
+}
+
+template <typename Trace, typename Model, typename Quirks>
+uint32_t BasicFakeChip8<Trace, Model, Quirks>::runBlocks(uint32_t budget, bool chain) {
+    // A halted pc may lie past blockAt_.
+    if (!running()) {
         return 0;
-    } },
-    { 1, [&](int opcode) {
-        auto oldpc = pc_ - 2;
-        pc_ = opcode & 0xfff;
-        if (oldpc == pc_) {
-            if (debug_) debugPrint_ << "stop";
-            toStop_ = true;
-        } else {
-            if (debug_) debugPrint_ << "goto pc=0x" << std::hex << pc_;
+    }
+    uint32_t executed = 0;
+    do {
+        uint16_t slot = blockAt_[state_.pc];
+        if (!slot) {
+            if (pageRewrites_[state_.pc >> CODE_PAGE_SHIFT] == SELF_MODIFYING_REWRITES) {
+                executed += interpretPage(budget - executed);
+                continue;
+            }
+            slot = decodeBlock(state_.pc);
         }
-        return 0;
-    } },
-    { 2, [&](int opcode) {
-        stack_.push_back(pc_);
-        pc_ = opcode & 0xfff;
-        if (debug_) debugPrint_ << "call pc=0x" << std::hex << pc_;
-        return 0;
-    } },
-    { 3, [&](int opcode) {
-        if (debug_) debugPrint_ << "cmp  V" << (int)arg(opcode, 1) << " 0x"
-            << std::hex << (int)vars_.at(arg(opcode, 1)) << "==0x" << (int)(opcode & 0xff);
-        if ((vars_.at(arg(opcode, 1)) == (opcode & 0xff))) {
-            if (debug_) debugPrint_ << " skip pc=" << pc_;
-            pc_ += 2;
+        executed += runBlock(blockPool_[slot - 1], budget - executed);
+    } while (chain && executed < budget && running() && !state_.waitingForKey && !drew_);
+    return executed;
+}
+
+// A skip before the last op moves on by one op or two, so pc is read back
+// after skips only.
+template <typename Trace, typename Model, typename Quirks>
+uint32_t BasicFakeChip8<Trace, Model, Quirks>::runBlock(Block const& block, uint32_t budget) {
+    uint32_t executed = 0;
+    for (uint32_t i = 0; i < block.count && executed < budget; ++executed) {
+        int address = block.start + 2 * static_cast<int>(i);
+        auto op = block.ops[i];
+        int opcode = op.opcode;
+        state_.pc = address + 2;
+        // The common ops run from here with their sub-op decoded; the rest
+        // through their opcode family's handler.
+        int x = arg(opcode, 1);
+        int y = arg(opcode, 2);
+        switch (op.op) {
+        case Op::LoadImm: opLoadImm(opcode); break;
+        case Op::AddImm: opAddImm(opcode); break;
+        case Op::Move: applyAluOp<Quirks, 0x0>(state_.v, x, y); break;
+        case Op::Or: applyAluOp<Quirks, 0x1>(state_.v, x, y); break;
+        case Op::And: applyAluOp<Quirks, 0x2>(state_.v, x, y); break;
+        case Op::Xor: applyAluOp<Quirks, 0x3>(state_.v, x, y); break;
+        case Op::Add: applyAluOp<Quirks, 0x4>(state_.v, x, y); break;
+        case Op::Sub: applyAluOp<Quirks, 0x5>(state_.v, x, y); break;
+        case Op::ShiftRight: applyAluOp<Quirks, 0x6>(state_.v, x, y); break;
+        case Op::SubReverse: applyAluOp<Quirks, 0x7>(state_.v, x, y); break;
+        case Op::ShiftLeft: applyAluOp<Quirks, 0xe>(state_.v, x, y); break;
+        case Op::SkipEqImm: opSkipEqImm(opcode); break;
+        case Op::SkipNeImm: opSkipNeImm(opcode); break;
+        case Op::SkipEqReg: opSkipEqReg(opcode); break;
+        case Op::SkipNeReg: opSkipNeReg(opcode); break;
+        case Op::LoadI: opLoadI(opcode); break;
+        case Op::Jump: opJump(opcode); break;
+        default: (this->*OP_HANDLERS[arg(opcode, 0)])(opcode); break;
         }
-        return 0;
-    } },
-    { 4, [&](int opcode) {
-        if (debug_) debugPrint_ << "cmp  V" << (int)arg(opcode, 1) << " 0x"
-            << std::hex << (int)vars_.at(arg(opcode, 1)) << "!=0x" << (int)(opcode & 0xff);
-        if ((vars_.at(arg(opcode, 1)) != (opcode & 0xff))) {
-            if (debug_) debugPrint_ << " skip pc=" << pc_;
-            pc_ += 2;
+        if constexpr (TRACE) traceInstruction(address, opcode);
+        if constexpr (PROFILE) profileInstruction(address, opcode);
+        i = op.skip ? (state_.pc - block.start) / 2 : i + 1;
+    }
+    return executed;
+}
+
+// Runs a self-modifying page like the interpreter, as one block that ends
+// where the interpreter would stop or pc leaves the page.
+template <typename Trace, typename Model, typename Quirks>
+uint32_t BasicFakeChip8<Trace, Model, Quirks>::interpretPage(uint32_t budget) {
+    int page = state_.pc >> CODE_PAGE_SHIFT;
+    uint32_t executed = 0;
+    do {
+        execute();
+        ++executed;
+    } while (executed < budget && state_.pc >> CODE_PAGE_SHIFT == page && running() && !state_.waitingForKey
+        && !drew_);
+    return executed;
+}
+
+// Decodes the block starting at `address` into the pool and returns its
+// slot; when the pool is full the cache starts over.
+template <typename Trace, typename Model, typename Quirks>
+uint16_t BasicFakeChip8<Trace, Model, Quirks>::decodeBlock(int address) {
+    if (usedBlocks_ == blockPool_.size()) {
+        std::fill(begin(blockAt_), end(blockAt_), 0);
+        usedBlocks_ = 0;
+    }
+    auto& block = blockPool_[usedBlocks_++];
+    block.start = address;
+    block.count = 0;
+    int pc = address;
+    do {
+        int opcode = (state_.memory[pc] << 8) | state_.memory[pc + 1];
+        Op op = decodeOp(opcode, Model::EXTENDED, Model::XO);
+        block.ops[block.count++] = { static_cast<uint16_t>(opcode), op, opInfo(op).flow == Flow::Skip };
+        pc += 2;
+        if (opInfo(op).endsBlock) {
+            break;
         }
-        return 0;
-    } },
-    { 5, [&](int opcode) {
-        if (debug_) debugPrint_ << "cmp  V" << (int)arg(opcode, 1) << "==V"
-            << (int)arg(opcode, 2) << " 0x" << std::hex << (int)vars_.at(arg(opcode, 1)) << " == 0x" << (int)(opcode & 0xff);
-        if ((vars_.at(arg(opcode, 1)) == vars_.at(arg(opcode, 2)))) {
-            if (debug_) debugPrint_ << " skip pc=" << pc_;
-            pc_ += 2;
+    } while (block.count < MAX_BLOCK_OPS && pc + 1 < static_cast<int>(Model::MEMORY));
+    pageHasCode_[address >> CODE_PAGE_SHIFT] = 1;
+    pageHasCode_[(pc - 1) >> CODE_PAGE_SHIFT] = 1;
+    return blockAt_[address] = static_cast<uint16_t>(usedBlocks_);
+}
+
+// Drops the blocks covering the written pages, if any; blocks elsewhere
+// stay valid.
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::invalidateCode(size_t address, size_t length) {
+    if (engine_ != Engine::CachedBlocks) {
+        return;
+    }
+    size_t pages = pageHasCode_.size();
+    size_t last = (address + length - 1) >> CODE_PAGE_SHIFT;
+    for (size_t page = address >> CODE_PAGE_SHIFT; page <= last; ++page) {
+        size_t index = page & (pages - 1);
+        if (!pageHasCode_[index]) {
+            continue;
         }
-        return 0;
-    } },
-    { 6, [&](int opcode) {
-        if (debug_) debugPrint_ << "asgn V" << std::hex << (int)arg(opcode, 1)
-            << "=0x" << (int)(opcode & 0xff);
-        vars_.at(arg(opcode, 1)) = opcode & 0xff;
-        vars_.at(arg(opcode, 1)) = vars_.at(arg(opcode, 1));
-        if (debug_) debugPrint_ << "\t =>" << (int)vars_.at(arg(opcode, 1));
-        return 0;
-    } },
-    { 7, [&](int opcode) {
-        if (debug_) debugPrint_ << "inc  V" << std::hex << (int)arg(opcode, 1) << "+=0x" << (int)(opcode & 0xff);
-        vars_.at(arg(opcode, 1)) += opcode & 0xff;
-        if (debug_) debugPrint_ << "\t =>" << (int)vars_.at(arg(opcode, 1));
-        return 0;
-    } },
-    { 8, [&](int opcode) {
-        if (debug_) debugPrint_ << "asgn V" << (int)arg(opcode, 1);
-        switch (arg(opcode, 3)) {
-        case 0x0:
-            vars_.at(arg(opcode, 1)) = vars_.at(arg(opcode, 2));
-            if (debug_) debugPrint_ << "=V" << (int)arg(opcode, 2);
-            break;
-        case 0x1:
-            vars_.at(arg(opcode, 1)) |= vars_.at(arg(opcode, 2));
-            if (debug_) debugPrint_ << "|=V" << (int)arg(opcode, 2);
-            break;
-        case 0x2:
-            if (debug_) debugPrint_ << "&=V" << (int)arg(opcode, 2) << "V" << (int)arg(opcode, 1);
-            vars_.at(arg(opcode, 1)) &= vars_.at(arg(opcode, 2));
-            break;
-        case 0x3:
-            if (debug_) debugPrint_ << "^=V" << (int)arg(opcode, 2);
-            vars_.at(arg(opcode, 1)) ^= vars_.at(arg(opcode, 2));
-            break;
-        case 0x4:
-            if (debug_) debugPrint_ << "+=V" << (int)arg(opcode, 2);
-            if (vars_.at(arg(opcode, 1)) + vars_.at(arg(opcode, 2)) > 0xff) {
-                vars_.at(FLAG_REG) = 1;
-            } else {
-                vars_.at(FLAG_REG) = 0;
-            }
-            vars_.at(arg(opcode, 1)) += vars_.at(arg(opcode, 2));
-            break;
-        case 0x5:
-            if (debug_) debugPrint_ << "-=V" << (int)arg(opcode, 2);
-            if (vars_.at(arg(opcode, 1)) >= vars_.at(arg(opcode, 2))) {
-                vars_.at(FLAG_REG) = 1;
-            } else {
-                vars_.at(FLAG_REG) = 0;
+        pageHasCode_[index] = 0;
+        pageRewrites_[index] += pageRewrites_[index] < SELF_MODIFYING_REWRITES;
+        // Blocks reaching into the page start less than a block's length
+        // before it.
+        size_t start = index * CODE_PAGE_SIZE;
+        size_t first = start >= 2 * MAX_BLOCK_OPS ? start + 2 - 2 * MAX_BLOCK_OPS : 0;
+        std::fill(begin(blockAt_) + first, begin(blockAt_) + start + CODE_PAGE_SIZE, 0);
+    }
+}
+
+template <typename Trace, typename Model, typename Quirks>
+bool BasicFakeChip8<Trace, Model, Quirks>::running() const {
+    return size_t{ state_.pc } + 1 < Model::MEMORY && !toStop_;
+}
+
+// XO-CHIP skips hop over the whole four-byte F000 nnnn.
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::skipNext() {
+    if constexpr (Model::XO) {
+        if (memoryAt(state_.pc) == 0xF0 && memoryAt(state_.pc + 1) == 0x00) {
+            state_.pc += 2;
+        }
+    }
+    state_.pc += 2;
+}
+
+template <typename Trace, typename Model, typename Quirks>
+template <typename F>
+void BasicFakeChip8<Trace, Model, Quirks>::forEachPlane(F&& f) {
+    if constexpr (Model::PLANES > 1) {
+        for (size_t index = 0; index < Model::PLANES; ++index) {
+            if (state_.planeMask & (1u << index)) {
+                f(state_.display[index], index);
             }
-            vars_.at(arg(opcode, 1)) -= vars_.at(arg(opcode, 2));
-            break;
-        case 0x6:
-            if (debug_) debugPrint_ << ">>=1";
-            vars_.at(FLAG_REG) = vars_.at(arg(opcode, 1)) & 0x1;
-            vars_.at(arg(opcode, 1)) >>= 1;
-            break;
-        case 0x7:
-            if (debug_) debugPrint_ << "=V" << (int)arg(opcode, 2) <<
-                "-V" << (int)arg(opcode, 1);
-            vars_.at(arg(opcode, 1)) = vars_.at(arg(opcode, 2)) - vars_.at(arg(opcode, 1));
-            break;
-        case 0xe:
-            if (debug_) debugPrint_ << "<<=1";
-            vars_.at(FLAG_REG) = !!(vars_.at(arg(opcode, 1)) & 0x80);
-            vars_.at(arg(opcode, 1)) <<= 1;
-            break;
-        default:
-            if (debug_) debugPrint_ << "NOT HANDLED";
-            throw std::runtime_error("NOT HANDLED" + std::to_string(opcode));
-            break;
         }
-        if (debug_) debugPrint_ << "\t =>" << (int)vars_.at(arg(opcode, 1));
-        return 0;
-    } },
-    { 9, [&](int opcode) {
-        if (vars_.at(arg(opcode, 1)) != vars_.at(arg(opcode, 2))) {
-            pc_ += 2;
+    } else {
+        f(state_.display, 0);
+    }
+}
+
+// Indexed by the top nibble of the opcode; built once instead of on every step.
+template <typename Trace, typename Model, typename Quirks>
+const typename BasicFakeChip8<Trace, Model, Quirks>::OpHandler BasicFakeChip8<Trace, Model, Quirks>::OP_HANDLERS[16] = {
+    &BasicFakeChip8::opSystem,
+    &BasicFakeChip8::opJump,
+    &BasicFakeChip8::opCall,
+    &BasicFakeChip8::opSkipEqImm,
+    &BasicFakeChip8::opSkipNeImm,
+    &BasicFakeChip8::opSkipEqReg,
+    &BasicFakeChip8::opLoadImm,
+    &BasicFakeChip8::opAddImm,
+    &BasicFakeChip8::opAlu,
+    &BasicFakeChip8::opSkipNeReg,
+    &BasicFakeChip8::opLoadI,
+    &BasicFakeChip8::opJumpV0,
+    &BasicFakeChip8::opRand,
+    &BasicFakeChip8::opDraw,
+    &BasicFakeChip8::opKey,
+    &BasicFakeChip8::opMisc,
+};
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opSystem(int opcode) {
+    if constexpr (Model::EXTENDED) {
+        if (opcode >> 8 == 0 && opcode != 0x00EE) {
+            opExtendedSystem(opcode);
+            return;
         }
-        return 0;
-    } },
-    { 0xa, [&](int opcode) {
-        regI_ = opcode & 0xfff;
-        if (debug_) debugPrint_ << "reg  I=0x" << std::hex << (int)regI_;
-        return 0;
-    } },
-    { 0xb, [&](int opcode) {
-        pc_ = vars_.at(0) + (opcode & 0xfff);
-        return 0;
-    } },
-    { 0xc, [&](int opcode) {
-        if (debug_) debugPrint_ << "rnd  V" << std::hex << (int)arg(opcode, 1)
-            << "= rand() & 0x" << std::hex << (int)(opcode & 0xff);
-        vars_.at(arg(opcode, 1)) = rand() & (opcode & 0xff);
-        return 0;
-    } },
-    { 0xd, [&](int opcode) {
-        int x = vars_.at(arg(opcode, 1)) % 64;
-        int y = vars_.at(arg(opcode, 2)) % 32;
-        int n = arg(opcode, 3);
-        if (debug_) debugPrint_ << "draw I=0x" << regI_
-            << std::dec << ":(" << x << ";" << y << ";" << n << ")";
-
-        constexpr bool collision = true;
-        constexpr size_t byteSize = 8;
-        vars_.at(FLAG_REG) = !collision;
-        for (size_t i = 0; i < n && (regI_ + i) < memory_.size() && y + i < rawDisplay_.size(); ++i) {
-            uint64_t lineGraphic = memory_.at(regI_ + i);
-            lineGraphic <<= byteSize * (sizeof(uint64_t) - 1);
-            if (rawDisplay_.at(y + i) & (lineGraphic >> x)) {
-                vars_.at(FLAG_REG) = collision;
-            }
-            rawDisplay_.at(y + i) ^= lineGraphic >> x;
+    } else if (opcode == 0x00E0) {
+        for (size_t row = 0; row < DISPLAY_ROWS; ++row) {
+            dirtyRows_ |= static_cast<uint32_t>(state_.display[row] != 0) << row;
         }
-        display_->draw(rawDisplay_);
-        return 0;
-    } },
-    { 0xe, [&](int opcode) {
-        if (debug_) debugPrint_ << "key" << std::hex << (int)vars_.at(arg(opcode, 1));
-        bool keyPressed = keyStates_[vars_.at(arg(opcode, 1))];
-        switch (opcode & 0xff) {
-        case 0x9E:
-            if (debug_) debugPrint_ << " ON ";
-            if (keyPressed) {
-                if (debug_) debugPrint_ << " skip pc=" << pc_;
-                pc_ += 2;
+        state_.display.fill(0);
+        return;
+    }
+    if (opcode == 0x00EE) {
+        if (state_.sp == 0) {
+            throw std::runtime_error("return with an empty stack at " + std::to_string(state_.pc - 2));
+        }
+        state_.pc = state_.stack[--state_.sp];
+        return;
+    }
+    state_.pc = opcode & 0xfff;
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opJump(int opcode) {
+    auto oldpc = state_.pc - 2;
+    state_.pc = opcode & 0xfff;
+    if (oldpc == state_.pc) {
+        toStop_ = true;
+    }
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opCall(int opcode) {
+    if (state_.sp == STACK_DEPTH) {
+        throw std::runtime_error("stack overflow at " + std::to_string(state_.pc - 2));
+    }
+    state_.stack[state_.sp++] = state_.pc;
+    state_.pc = opcode & 0xfff;
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opSkipEqImm(int opcode) {
+    if (state_.v[arg(opcode, 1)] == (opcode & 0xff)) {
+        skipNext();
+    }
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opSkipNeImm(int opcode) {
+    if (state_.v[arg(opcode, 1)] != (opcode & 0xff)) {
+        skipNext();
+    }
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opSkipEqReg(int opcode) {
+    if constexpr (Model::XO) {
+        if ((opcode & 0xf) == 2 || (opcode & 0xf) == 3) {
+            opRegisterRange(opcode);
+            return;
+        }
+    }
+    if (state_.v[arg(opcode, 1)] == state_.v[arg(opcode, 2)]) {
+        skipNext();
+    }
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opLoadImm(int opcode) {
+    state_.v[arg(opcode, 1)] = opcode & 0xff;
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opAddImm(int opcode) {
+    state_.v[arg(opcode, 1)] += opcode & 0xff;
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opAlu(int opcode) {
+    applyAlu<Quirks>(state_.v, opcode);
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opSkipNeReg(int opcode) {
+    if (state_.v[arg(opcode, 1)] != state_.v[arg(opcode, 2)]) {
+        skipNext();
+    }
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opLoadI(int opcode) {
+    state_.regI = opcode & 0xfff;
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opJumpV0(int opcode) {
+    state_.pc = state_.v[Quirks::jumpUsesVx ? arg(opcode, 1) : 0] + (opcode & 0xfff);
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opRand(int opcode) {
+    state_.v[arg(opcode, 1)] = nextRandomByte(state_.random) & (opcode & 0xff);
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opDraw(int opcode) {
+    int n = arg(opcode, 3);
+    if constexpr (Model::EXTENDED) {
+        if constexpr (TRACE) {
+            drawX_ = state_.v[arg(opcode, 1)] % (state_.hiRes ? 128 : 64);
+            drawY_ = state_.v[arg(opcode, 2)] % (state_.hiRes ? 64 : 32);
+        }
+        drawHiRes(state_.v[arg(opcode, 1)], state_.v[arg(opcode, 2)], n);
+    } else {
+        int x = state_.v[arg(opcode, 1)] % 64;
+        int y = state_.v[arg(opcode, 2)] % 32;
+        if constexpr (TRACE) {
+            drawX_ = static_cast<uint8_t>(x);
+            drawY_ = static_cast<uint8_t>(y);
+        }
+        uint64_t lines[MAX_SPRITE_LINES];
+        size_t count = loadSprite(state_.memory.data(), MEM_SIZE, state_.regI, n, lines);
+        auto blit = blitSprite(state_.display.data(), lines, count, x, y, Quirks::spriteEdge);
+        state_.v[FLAG_REG] = blit.collision;
+        dirtyRows_ |= blit.dirtyRows;
+    }
+    drew_ = true;
+    if constexpr (PROFILE) {
+        if (profile_) {
+            ++profile_->draws;
+            profile_->collisions += state_.v[FLAG_REG];
+        }
+    }
+}
+
+// SUPER-CHIP sprites: 16x16 for Dxy0, and in low resolution every pixel
+// doubled. XO-CHIP draws the sprite once per selected plane, the planes'
+// data following each other in memory.
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::drawHiRes(int x, int y, int n) {
+    if constexpr (Model::EXTENDED) {
+        size_t address = state_.regI;
+        bool collision = false;
+        forEachPlane([&](HiResFramebuffer& plane, size_t) {
+            uint64_t lines[MAX_SPRITE_LINES];
+            size_t count = n == 0
+                ? loadWideSprite(state_.memory.data(), Model::MEMORY, address, lines)
+                : loadSprite(state_.memory.data(), Model::MEMORY, address, n, lines);
+            address += n == 0 ? 2 * MAX_SPRITE_LINES : n;
+            BlitResult blit;
+            if (state_.hiRes) {
+                blit = blitSprite(plane, lines, count, x % 128, y % 64, Quirks::spriteEdge);
+            } else {
+                uint64_t doubled[2 * MAX_SPRITE_LINES];
+                for (size_t i = 0; i < count; ++i) {
+                    doubled[2 * i] = doubled[2 * i + 1] = doublePixels(lines[i]);
+                }
+                blit = blitSprite(plane, doubled, 2 * count, x % 64 * 2, y % 32 * 2, Quirks::spriteEdge);
             }
-            break;
-        case 0xA1:
-            if (debug_) debugPrint_ << " OFF";
-            if (!keyPressed) {
-                if (debug_) debugPrint_ << " skip pc=" << pc_;
-                pc_ += 2;
+            collision |= blit.collision;
+            dirtyRows_ |= blit.dirtyRows;
+        });
+        state_.v[FLAG_REG] = collision;
+    }
+}
+
+// 00Cn, 00Dn, 00E0 and 00FB-00FF. Scroll distances are in pixels of the
+// current resolution, so doubled in low resolution.
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opExtendedSystem(int opcode) {
+    if constexpr (Model::EXTENDED) {
+        unsigned scale = state_.hiRes ? 1 : 2;
+        auto clear = [](HiResFramebuffer& plane, size_t) { plane.fill({}); };
+        switch (opcode & 0xf0) {
+        case 0xC0:
+            forEachPlane([&](HiResFramebuffer& plane, size_t) { scrollDown(plane, (opcode & 0xf) * scale); });
+            dirtyRows_ = ALL_ROWS;
+            return;
+        case 0xD0:
+            if constexpr (Model::XO) {
+                forEachPlane([&](HiResFramebuffer& plane, size_t) { scrollUp(plane, (opcode & 0xf) * scale); });
+                dirtyRows_ = ALL_ROWS;
             }
-            break;
+            return;
         }
-        return 0;
-    } },
-    { 0xf, [&](int opcode) {
-        int val = vars_.at(arg(opcode, 1));
-        int type = opcode & 0xff;
-        switch (type) {
-        case 0x07:
-            if (debug_) debugPrint_ << "time V" << (int)arg(opcode, 1) << "=" << timer_;
-            vars_.at(arg(opcode, 1)) = timer_;
+        switch (opcode) {
+        case 0x00E0:
+            forEachPlane(clear);
+            dirtyRows_ = ALL_ROWS;
             break;
-        case 0x0a:
-            if (debug_) debugPrint_ << "key  V" << (int)arg(opcode, 1);
-            blockKeyVar_ = arg(opcode, 1);
-            pendingKeyRead_ = true;
+        case 0x00FB:
+            forEachPlane([&](HiResFramebuffer& plane, size_t) { scrollRight(plane, 4 * scale); });
+            dirtyRows_ = ALL_ROWS;
             break;
-        case 0x15:
-            if (debug_) debugPrint_ << "time t=" << (int)arg(opcode, 1);
-            timer_ = vars_.at(arg(opcode, 1));
+        case 0x00FC:
+            forEachPlane([&](HiResFramebuffer& plane, size_t) { scrollLeft(plane, 4 * scale); });
+            dirtyRows_ = ALL_ROWS;
             break;
-        case 0x18:
-            if (debug_) debugPrint_ << "snd  s=" << (int)arg(opcode, 1);
-            sound_ = vars_.at(arg(opcode, 1));
-            break;
-        case 0x1e:
-            if (debug_)
-                debugPrint_ << "inc  I+=V" << std::hex << (int)arg(opcode, 1)
-                << "\t =>" << (int)regI_;
-            regI_ += vars_.at(arg(opcode, 1));
+        case 0x00FD:
+            toStop_ = true;
             break;
-        case 0x29:
-        {
-            size_t fontSize = 5;
-            regI_ = static_cast<size_t>(vars_.at(arg(opcode, 1)) * fontSize);
-            if (debug_) debugPrint_ << "reg  I=0x" << std::hex << regI_ << "(font)";
+        case 0x00FE:
+        case 0x00FF:
+            state_.hiRes = opcode == 0x00FF;
+            state_.display = {};
+            dirtyRows_ = ALL_ROWS;
             break;
         }
-        case 0x33:
-            if (debug_) debugPrint_ << "bcd  load 0x" << val;
-            memory_.at(regI_ + 2) = val % 10;
-            val /= 10;
-            memory_.at(regI_ + 1) = val % 10;
-            val /= 10;
-            memory_.at(regI_ + 0) = val % 10;
-            if (debug_) debugPrint_ << " (" << (int)(memory_.at(regI_ + 0))
-                << ";" << (int)(memory_.at(regI_ + 1))
-                << ";" << (int)(memory_.at(regI_ + 2)) << ")";
-            break;
-        case 0x55:
-            if (debug_) debugPrint_ << "reg  dump V[0;" << arg(opcode, 1) << "]";
-            for (size_t i = 0; i <= arg(opcode, 1); ++i) {
-                memory_.at(regI_ + i) = vars_.at(i);
-            }
-            break;
-        case 0x65:
-            if (debug_) debugPrint_ << "reg  load V[0;" << arg(opcode, 1) << "]";
-            for (size_t i = 0; i <= arg(opcode, 1); ++i) {
-                vars_.at(i) = memory_.at(regI_ + i);
+    }
+}
+
+// XO-CHIP 5xy2 / 5xy3: store or load Vx..Vy at I, in either order, leaving
+// I alone.
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opRegisterRange(int opcode) {
+    if constexpr (Model::XO) {
+        int x = arg(opcode, 1);
+        int y = arg(opcode, 2);
+        int step = x <= y ? 1 : -1;
+        int count = std::abs(y - x) + 1;
+        bool store = (opcode & 0xf) == 2;
+        for (int i = 0; i < count; ++i) {
+            auto& cell = memoryAt(state_.regI + i);
+            auto& reg = state_.v[x + i * step];
+            if (store) {
+                cell = reg;
+            } else {
+                reg = cell;
             }
-            break;
         }
-        return 0;
-    } }
-        } };
+        if (store) {
+            invalidateCode(state_.regI, count);
+        }
+    }
+}
 
-    calls[arg(opcode, 0)](opcode);
-    flushDebugToStdout();
-    return pc_ < memory_.size() && !toStop_;
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opKey(int opcode) {
+    bool keyPressed = keyStates_[state_.v[arg(opcode, 1)] & 0xf];
+    switch (opcode & 0xff) {
+    case 0x9E:
+        if (keyPressed) {
+            skipNext();
+        }
+        break;
+    case 0xA1:
+        if (!keyPressed) {
+            skipNext();
+        }
+        break;
+    }
 }
 
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::opMisc(int opcode) {
+    int x = arg(opcode, 1);
+    int val = state_.v[x];
+    int type = opcode & 0xff;
+    switch (type) {
+    case 0x07:
+        state_.v[x] = state_.delayTimer;
+        break;
+    case 0x0a:
+        state_.keyRegister = x;
+        state_.waitingForKey = true;
+        break;
+    case 0x15:
+        state_.delayTimer = state_.v[x];
+        break;
+    case 0x18:
+        state_.soundTimer = state_.v[x];
+        break;
+    case 0x1e:
+        state_.regI += state_.v[x];
+        break;
+    case 0x29:
+    {
+        size_t fontSize = 5;
+        state_.regI = static_cast<uint16_t>(state_.v[x] * fontSize);
+        break;
+    }
+    case 0x30:
+        if constexpr (Model::EXTENDED) {
+            state_.regI = static_cast<uint16_t>(BIG_FONT_START + (state_.v[x] & 0xf) * 10);
+        }
+        break;
+    case 0x75:
+        if constexpr (Model::EXTENDED) {
+            std::copy_n(begin(state_.v), x + 1, begin(state_.flags));
+        }
+        break;
+    case 0x85:
+        if constexpr (Model::EXTENDED) {
+            std::copy_n(begin(state_.flags), x + 1, begin(state_.v));
+        }
+        break;
+    case 0x00:
+        if constexpr (Model::XO) {
+            if (x == 0) {
+                state_.regI = static_cast<uint16_t>(memoryAt(state_.pc) << 8 | memoryAt(state_.pc + 1));
+                state_.pc += 2;
+            }
+        }
+        break;
+    case 0x01:
+        if constexpr (Model::XO) {
+            state_.planeMask = static_cast<uint8_t>(x & ((1 << Model::PLANES) - 1));
+        }
+        break;
+    case 0x33:
+        memoryAt(state_.regI + 2) = val % 10;
+        val /= 10;
+        memoryAt(state_.regI + 1) = val % 10;
+        val /= 10;
+        memoryAt(state_.regI + 0) = val % 10;
+        invalidateCode(state_.regI, 3);
+        break;
+    case 0x55:
+        for (int i = 0; i <= x; ++i) {
+            memoryAt(state_.regI + i) = state_.v[i];
+        }
+        invalidateCode(state_.regI, x + 1);
+        advanceIndex(x);
+        break;
+    case 0x65:
+        for (int i = 0; i <= x; ++i) {
+            state_.v[i] = memoryAt(state_.regI + i);
+        }
+        advanceIndex(x);
+        break;
+    }
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::advanceIndex(int x) {
+    if constexpr (Quirks::loadStoreIncrement == IndexIncrement::ByX) {
+        state_.regI += x;
+    } else if constexpr (Quirks::loadStoreIncrement == IndexIncrement::ByXPlusOne) {
+        state_.regI += x + 1;
+    }
+}
 
-bool FakeChip8::handleGetKey() {
+template <typename Trace, typename Model, typename Quirks>
+bool BasicFakeChip8<Trace, Model, Quirks>::handleGetKey() {
     keyStates_ = inputIO_->read();
-    if (keyStates_.any() && pendingKeyRead_) {
+    if (keyStates_.any() && state_.waitingForKey) {
         for (size_t i = 0; i < keyStates_.size(); ++i) {
             if (keyStates_[i]) {
-                vars_.at(blockKeyVar_) = i;
+                state_.v[state_.keyRegister] = i;
             }
         }
-        pendingKeyRead_ = false;
+        state_.waitingForKey = false;
     }
-    return pendingKeyRead_;
+    return state_.waitingForKey;
 }
 
-constexpr int FakeChip8::arg(int opcode, int n) const {
+template <typename Trace, typename Model, typename Quirks>
+constexpr int BasicFakeChip8<Trace, Model, Quirks>::arg(int opcode, int n) const {
     return opcode >> (4 * (3 - n)) & 0xf;
 }
 
-void FakeChip8::handleStep() {
-    if (timer_) --timer_;
-    if (sound_) --sound_;
+// Addresses past the end wrap around, as I can point anywhere in 64 KB.
+template <typename Trace, typename Model, typename Quirks>
+uint8_t& BasicFakeChip8<Trace, Model, Quirks>::memoryAt(size_t address) {
+    return state_.memory[address & (Model::MEMORY - 1)];
 }
 
-int FakeChip8::readOpCode() {
-    int val = (memory_.at(pc_) << 8) | (memory_.at(pc_ + 1));
-    pc_ += 2;
-    return val;
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::tickTimers() {
+    if (state_.delayTimer) --state_.delayTimer;
+    if (state_.soundTimer) --state_.soundTimer;
 }
 
-void  FakeChip8::flushDebugToStdout() {
-    if (debug_) {
-        auto const& debugOutput = debugPrint_.str();
-        if (!debugOutput.empty()) {
-            std::cout << debugPrint_.str() << '\n';
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::presentFrame() {
+    if (dirtyRows_ && display_) {
+        if constexpr (Model::PLANES > 1) {
+            display_->updateHiRes(state_.display.data(), Model::PLANES, dirtyRows_);
+        } else if constexpr (Model::EXTENDED) {
+            display_->updateHiRes(&state_.display, 1, dirtyRows_);
+        } else {
+            display_->update(state_.display, static_cast<uint32_t>(dirtyRows_));
         }
+        dirtyRows_ = 0;
+    }
+}
+
+template <typename Trace, typename Model, typename Quirks>
+int BasicFakeChip8<Trace, Model, Quirks>::readOpCode() {
+    int val = (state_.memory[state_.pc] << 8) | state_.memory[state_.pc + 1];
+    state_.pc += 2;
+    return val;
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::traceInstruction(int pc, int opcode) {
+    if (!traceSink_) {
+        return;
     }
-    debugPrint_.str("");
+    TraceRecord record{};
+    record.pc = static_cast<uint16_t>(pc);
+    record.opcode = static_cast<uint16_t>(opcode);
+    record.regI = state_.regI;
+    record.reg = tracedRegister(opcode);
+    if (record.reg != NO_REGISTER) {
+        record.value = state_.v[record.reg];
+    } else if (opcode >> 12 == 0xd) {
+        record.reg = drawX_;
+        record.value = drawY_;
+    }
+    traceSink_->record(record);
 }
 
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::profileInstruction(int pc, int opcode) {
+    if (!profile_) {
+        return;
+    }
+    ++profile_->opcodes[opcode & 0xffff];
+    ++profile_->addresses[pc];
+}
+
+template <typename Trace, typename Model, typename Quirks>
+void BasicFakeChip8<Trace, Model, Quirks>::profileKeyWait(uint64_t cycles) {
+    if (profile_) {
+        profile_->keyWaitCycles += cycles;
+    }
+}
+
+template class BasicFakeChip8<NoTrace, Chip8Model, LegacyQuirks>;
+template class BasicFakeChip8<NoTrace, Chip8Model, CosmacVipQuirks>;
+template class BasicFakeChip8<NoTrace, Chip8Model, Chip48Quirks>;
+template class BasicFakeChip8<NoTrace, Chip8Model, SuperChipQuirks>;
+template class BasicFakeChip8<NoTrace, Chip8Model, XoChipQuirks>;
+template class BasicFakeChip8<NoTrace, SuperChipModel, SuperChipQuirks>;
+template class BasicFakeChip8<NoTrace, XoChipModel, XoChipQuirks>;
+template class BasicFakeChip8<BinaryTrace, Chip8Model, LegacyQuirks>;
+template class BasicFakeChip8<BinaryTrace, Chip8Model, CosmacVipQuirks>;
+template class BasicFakeChip8<BinaryTrace, Chip8Model, Chip48Quirks>;
+template class BasicFakeChip8<BinaryTrace, Chip8Model, SuperChipQuirks>;
+template class BasicFakeChip8<BinaryTrace, Chip8Model, XoChipQuirks>;
+template class BasicFakeChip8<BinaryTrace, SuperChipModel, SuperChipQuirks>;
+template class BasicFakeChip8<BinaryTrace, XoChipModel, XoChipQuirks>;
+template class BasicFakeChip8<Profiling, Chip8Model, LegacyQuirks>;
+template class BasicFakeChip8<Profiling, Chip8Model, CosmacVipQuirks>;
+template class BasicFakeChip8<Profiling, Chip8Model, Chip48Quirks>;
+template class BasicFakeChip8<Profiling, Chip8Model, SuperChipQuirks>;
+template class BasicFakeChip8<Profiling, Chip8Model, XoChipQuirks>;
+template class BasicFakeChip8<Profiling, SuperChipModel, SuperChipQuirks>;
+template class BasicFakeChip8<Profiling, XoChipModel, XoChipQuirks>;
+
 } // namespace fakers
\ No newline at end of file
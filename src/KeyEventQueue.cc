@@ -0,0 +1,110 @@
+#include "KeyEventQueue.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace fakers
+{
+bool KeyEventQueue::push(int key, bool pressed) {
+    if (!events_.push({ 0, static_cast<uint8_t>(key), pressed })) {
+        return false;
+    }
+    // Taking the mutex orders the push before a waiter's predicate check,
+    // so the notification cannot fall between check and sleep.
+    { std::lock_guard<std::mutex> lock{ mutex_ }; }
+    queued_.notify_all();
+    return true;
+}
+
+void KeyEventQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock{ mutex_ };
+        closed_ = true;
+    }
+    queued_.notify_all();
+}
+
+size_t KeyEventQueue::deliver(uint64_t cycle) {
+    std::bitset<16> changed;
+    size_t applied = 0;
+    KeyTransition event;
+    while (held_ || events_.pop(event)) {
+        if (held_) {
+            event = *held_;
+            held_.reset();
+        }
+        if (changed[event.key]) {
+            held_ = event;
+            break;
+        }
+        changed[event.key] = true;
+        keys_[event.key] = event.pressed;
+        event.cycle = cycle;
+        if (log_) {
+            log_->push_back(event);
+        }
+        ++applied;
+    }
+    return applied;
+}
+
+bool KeyEventQueue::waitForKey(std::chrono::steady_clock::time_point deadline) {
+    if (held_) {
+        return true;
+    }
+    std::unique_lock<std::mutex> lock{ mutex_ };
+    queued_.wait_until(lock, deadline, [this] { return closed_ || !events_.empty(); });
+    return !events_.empty();
+}
+
+void writeKeyLog(std::ostream& os, std::vector<KeyTransition> const& log) {
+    os << "# cycle key down|up\n";
+    for (auto const& event : log) {
+        os << event.cycle << ' ' << std::hex << int{ event.key } << std::dec << ' '
+           << (event.pressed ? "down" : "up") << '\n';
+    }
+}
+
+std::vector<KeyTransition> readKeyLog(std::istream& is) {
+    std::vector<KeyTransition> log;
+    std::string line;
+    for (int number = 1; std::getline(is, line); ++number) {
+        auto comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        std::istringstream fields{ line };
+        uint64_t cycle;
+        int key;
+        std::string direction;
+        if (!(fields >> cycle)) {
+            continue;
+        }
+        if (!(fields >> std::hex >> key) || key < 0 || key > 0xf || !(fields >> direction)
+            || (direction != "down" && direction != "up")) {
+            throw std::runtime_error("bad key event on line " + std::to_string(number));
+        }
+        if (!log.empty() && cycle < log.back().cycle) {
+            throw std::runtime_error("key events out of order on line " + std::to_string(number));
+        }
+        log.push_back({ cycle, static_cast<uint8_t>(key), direction == "down" });
+    }
+    return log;
+}
+
+std::vector<KeyEvent> keyScript(std::vector<KeyTransition> const& log) {
+    std::vector<KeyEvent> script;
+    std::bitset<16> keys;
+    for (auto const& event : log) {
+        keys[event.key] = event.pressed;
+        if (!script.empty() && script.back().cycle == event.cycle) {
+            script.back().keys = keys;
+        } else {
+            script.push_back({ event.cycle, keys });
+        }
+    }
+    return script;
+}
+
+} // namespace fakers
@@ -0,0 +1,645 @@
+#include "LockstepChip8.h"
+
+#include "Chip8Ops.h"
+#include "SpriteBlit.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace fakers
+{
+namespace
+{
+constexpr uint8_t CHIP8_FONT_SET[80] =
+{
+    0xF0, 0x90, 0x90, 0x90, 0xF0, //0
+    0x20, 0x60, 0x20, 0x20, 0x70, //1
+    0xF0, 0x10, 0xF0, 0x80, 0xF0, //2
+    0xF0, 0x10, 0xF0, 0x10, 0xF0, //3
+    0x90, 0x90, 0xF0, 0x10, 0x10, //4
+    0xF0, 0x80, 0xF0, 0x10, 0xF0, //5
+    0xF0, 0x80, 0xF0, 0x90, 0xF0, //6
+    0xF0, 0x10, 0x20, 0x40, 0x40, //7
+    0xF0, 0x90, 0xF0, 0x90, 0xF0, //8
+    0xF0, 0x90, 0xF0, 0x10, 0xF0, //9
+    0xF0, 0x90, 0xF0, 0x90, 0x90, //A
+    0xE0, 0x90, 0xE0, 0x90, 0xE0, //B
+    0xF0, 0x80, 0x80, 0x80, 0xF0, //C
+    0xE0, 0x90, 0x90, 0x90, 0xE0, //D
+    0xF0, 0x80, 0xF0, 0x80, 0xF0, //E
+    0xF0, 0x80, 0xF0, 0x80, 0x80  //F
+};
+
+// Lane storage is padded to this, a multiple of every vector width below.
+constexpr size_t LANE_ALIGN = 32;
+
+// Byte lanes of one SIMD register. Masks are 0xff/0x00 per lane.
+#if defined(__AVX2__)
+struct Bytes {
+    static constexpr size_t WIDTH = 32;
+    __m256i v;
+
+    static Bytes load(uint8_t const* p) { return { _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)) }; }
+    void store(uint8_t* p) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static Bytes splat(uint8_t value) { return { _mm256_set1_epi8(static_cast<char>(value)) }; }
+};
+inline Bytes operator+(Bytes a, Bytes b) { return { _mm256_add_epi8(a.v, b.v) }; }
+inline Bytes operator-(Bytes a, Bytes b) { return { _mm256_sub_epi8(a.v, b.v) }; }
+inline Bytes operator|(Bytes a, Bytes b) { return { _mm256_or_si256(a.v, b.v) }; }
+inline Bytes operator&(Bytes a, Bytes b) { return { _mm256_and_si256(a.v, b.v) }; }
+inline Bytes operator^(Bytes a, Bytes b) { return { _mm256_xor_si256(a.v, b.v) }; }
+inline Bytes andNot(Bytes mask, Bytes a) { return { _mm256_andnot_si256(mask.v, a.v) }; }
+inline Bytes equal(Bytes a, Bytes b) { return { _mm256_cmpeq_epi8(a.v, b.v) }; }
+inline Bytes maxU(Bytes a, Bytes b) { return { _mm256_max_epu8(a.v, b.v) }; }
+inline Bytes subSaturated(Bytes a, Bytes b) { return { _mm256_subs_epu8(a.v, b.v) }; }
+inline Bytes shiftRight1(Bytes a) { return { _mm256_and_si256(_mm256_srli_epi16(a.v, 1), _mm256_set1_epi8(0x7f)) }; }
+inline Bytes select(Bytes mask, Bytes a, Bytes b) { return { _mm256_blendv_epi8(b.v, a.v, mask.v) }; }
+#elif defined(__SSE2__) || defined(_M_X64)
+struct Bytes {
+    static constexpr size_t WIDTH = 16;
+    __m128i v;
+
+    static Bytes load(uint8_t const* p) { return { _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)) }; }
+    void store(uint8_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static Bytes splat(uint8_t value) { return { _mm_set1_epi8(static_cast<char>(value)) }; }
+};
+inline Bytes operator+(Bytes a, Bytes b) { return { _mm_add_epi8(a.v, b.v) }; }
+inline Bytes operator-(Bytes a, Bytes b) { return { _mm_sub_epi8(a.v, b.v) }; }
+inline Bytes operator|(Bytes a, Bytes b) { return { _mm_or_si128(a.v, b.v) }; }
+inline Bytes operator&(Bytes a, Bytes b) { return { _mm_and_si128(a.v, b.v) }; }
+inline Bytes operator^(Bytes a, Bytes b) { return { _mm_xor_si128(a.v, b.v) }; }
+inline Bytes andNot(Bytes mask, Bytes a) { return { _mm_andnot_si128(mask.v, a.v) }; }
+inline Bytes equal(Bytes a, Bytes b) { return { _mm_cmpeq_epi8(a.v, b.v) }; }
+inline Bytes maxU(Bytes a, Bytes b) { return { _mm_max_epu8(a.v, b.v) }; }
+inline Bytes subSaturated(Bytes a, Bytes b) { return { _mm_subs_epu8(a.v, b.v) }; }
+inline Bytes shiftRight1(Bytes a) { return { _mm_and_si128(_mm_srli_epi16(a.v, 1), _mm_set1_epi8(0x7f)) }; }
+inline Bytes select(Bytes mask, Bytes a, Bytes b) { return { _mm_or_si128(_mm_and_si128(mask.v, a.v), _mm_andnot_si128(mask.v, b.v)) }; }
+#else
+struct Bytes {
+    static constexpr size_t WIDTH = 1;
+    uint8_t v;
+
+    static Bytes load(uint8_t const* p) { return { *p }; }
+    void store(uint8_t* p) const { *p = v; }
+    static Bytes splat(uint8_t value) { return { value }; }
+};
+inline Bytes operator+(Bytes a, Bytes b) { return { static_cast<uint8_t>(a.v + b.v) }; }
+inline Bytes operator-(Bytes a, Bytes b) { return { static_cast<uint8_t>(a.v - b.v) }; }
+inline Bytes operator|(Bytes a, Bytes b) { return { static_cast<uint8_t>(a.v | b.v) }; }
+inline Bytes operator&(Bytes a, Bytes b) { return { static_cast<uint8_t>(a.v & b.v) }; }
+inline Bytes operator^(Bytes a, Bytes b) { return { static_cast<uint8_t>(a.v ^ b.v) }; }
+inline Bytes andNot(Bytes mask, Bytes a) { return { static_cast<uint8_t>(~mask.v & a.v) }; }
+inline Bytes equal(Bytes a, Bytes b) { return { static_cast<uint8_t>(a.v == b.v ? 0xff : 0) }; }
+inline Bytes maxU(Bytes a, Bytes b) { return { std::max(a.v, b.v) }; }
+inline Bytes subSaturated(Bytes a, Bytes b) { return { static_cast<uint8_t>(a.v > b.v ? a.v - b.v : 0) }; }
+inline Bytes shiftRight1(Bytes a) { return { static_cast<uint8_t>(a.v >> 1) }; }
+inline Bytes select(Bytes mask, Bytes a, Bytes b) { return { static_cast<uint8_t>((mask.v & a.v) | (~mask.v & b.v)) }; }
+#endif
+
+static_assert(LANE_ALIGN % Bytes::WIDTH == 0, "lane padding must cover a whole vector");
+
+// V0-VF of one lane, seen through the SoA arrays.
+struct LaneRegisters {
+    std::array<std::vector<uint8_t>, 16>& v;
+    size_t lane;
+
+    uint8_t& operator[](int r) { return v[r][lane]; }
+};
+
+constexpr int arg(int opcode, int n) {
+    return opcode >> (4 * (3 - n)) & 0xf;
+}
+
+// Whether `opcode` may leave pc anywhere but on the next instruction.
+constexpr bool mayJump(int opcode) {
+    switch (opcode >> 12) {
+    case 0x0:
+        return opcode != 0x00E0;
+    case 0x1:
+    case 0x2:
+    case 0x3:
+    case 0x4:
+    case 0x5:
+    case 0x9:
+    case 0xb:
+    case 0xe:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+LockstepChip8::LockstepChip8(size_t lanes)
+    : lanes_(lanes), stride_((lanes + LANE_ALIGN - 1) / LANE_ALIGN * LANE_ALIGN) {
+    for (auto& v : v_) {
+        v.assign(stride_, 0);
+    }
+    pc_.assign(stride_, 0);
+    regI_.assign(stride_, 0);
+    delay_.assign(stride_, 0);
+    sound_.assign(stride_, 0);
+    keys_.assign(stride_, 0);
+    halted_.assign(stride_, 1);
+    waiting_.assign(stride_, 0);
+    waitRegister_.assign(stride_, 0);
+    stack_.assign(stride_ * STACK_DEPTH, 0);
+    sp_.assign(stride_, 0);
+    seeds_.assign(stride_, DEFAULT_SEED);
+    random_.assign(stride_, seedRandom(DEFAULT_SEED));
+    memory_.assign(stride_ * MEM_SIZE, 0);
+    display_.assign(stride_ * DISPLAY_ROWS, 0);
+    members_.assign(lanes_, 0);
+    groupStart_.assign(lanes_ + 1, 0);
+    groupAt_.assign(MEM_SIZE, 0);
+    groupOf_.assign(lanes_, 0);
+    masks_.assign(lanes_ / 2 * stride_, 0);
+    groupMask_.assign(lanes_, 0);
+    skip_.assign(stride_, 0);
+}
+
+void LockstepChip8::load(const std::vector<uint8_t>& program) {
+    if (program.size() > MEM_SIZE - MEM_START) {
+        throw std::runtime_error("program does not fit in memory: " + std::to_string(program.size()));
+    }
+    for (auto& v : v_) {
+        std::fill(begin(v), end(v), 0);
+    }
+    std::fill(begin(memory_), end(memory_), 0);
+    std::fill(begin(display_), end(display_), 0);
+    for (size_t lane = 0; lane < lanes_; ++lane) {
+        auto* memory = laneMemory(lane);
+        std::copy(std::begin(CHIP8_FONT_SET), std::end(CHIP8_FONT_SET), memory);
+        std::copy(begin(program), end(program), memory + MEM_START);
+        pc_[lane] = MEM_START;
+        halted_[lane] = 0;
+        random_[lane] = seedRandom(seeds_[lane]);
+    }
+    std::fill(begin(regI_), end(regI_), 0);
+    std::fill(begin(delay_), end(delay_), 0);
+    std::fill(begin(sound_), end(sound_), 0);
+    std::fill(begin(waiting_), end(waiting_), 0);
+    std::fill(begin(sp_), end(sp_), 0);
+    writtenPages_.reset();
+}
+
+void LockstepChip8::setKeys(size_t lane, std::bitset<16> keys) {
+    keys_.at(lane) = static_cast<uint16_t>(keys.to_ulong());
+}
+
+void LockstepChip8::seed(size_t lane, uint64_t seed) {
+    seeds_.at(lane) = seed;
+    random_[lane] = seedRandom(seed);
+}
+
+RunResult LockstepChip8::runCycles(uint32_t budget) {
+    // Lanes may have been loaded, woken or left mid-group by a throw since
+    // the last slice.
+    regroup_ = true;
+    // Like FakeChip8, input is sampled once per slice: a lane parked on Fx0A
+    // picks up its keys here and nowhere else.
+    for (size_t lane = 0; lane < lanes_; ++lane) {
+        if (waiting_[lane] && keys_[lane]) {
+            int key = 15;
+            while (!(keys_[lane] & (1 << key))) {
+                --key;
+            }
+            v_[waitRegister_[lane]][lane] = static_cast<uint8_t>(key);
+            waiting_[lane] = 0;
+        }
+    }
+    for (uint32_t cycles = 0; cycles < budget; ++cycles) {
+        if (!step()) {
+            bool allHalted = std::all_of(begin(halted_), end(halted_), [](uint8_t halted) { return halted; });
+            return { allHalted ? StopReason::Halted : StopReason::WaitingForKey, cycles };
+        }
+    }
+    return { StopReason::BudgetExhausted, budget };
+}
+
+void LockstepChip8::tickTimers() {
+    auto one = Bytes::splat(1);
+    for (size_t lane = 0; lane < stride_; lane += Bytes::WIDTH) {
+        subSaturated(Bytes::load(&delay_[lane]), one).store(&delay_[lane]);
+        subSaturated(Bytes::load(&sound_[lane]), one).store(&sound_[lane]);
+    }
+}
+
+LaneState LockstepChip8::lane(size_t lane) const {
+    LaneState state;
+    state.pc_ = pc_.at(lane);
+    state.regI_ = regI_[lane];
+    for (int r = 0; r < 16; ++r) {
+        state.registers_[r] = v_[r][lane];
+    }
+    std::copy_n(laneMemory(lane), MEM_SIZE, state.memory_.data());
+    std::copy_n(begin(display_) + lane * DISPLAY_ROWS, DISPLAY_ROWS, state.display_.data());
+    return state;
+}
+
+// Executes one instruction on every runnable lane and returns how many ran.
+// Unless some lane wrote to the code page, equal pcs imply equal opcodes.
+// A group whose lanes end up on different pcs, or that may have jumped
+// onto another group's pc, makes the next step regroup. The lane loops work
+// on raw pointers so that the compiler does not reload the vectors' storage
+// after every store.
+size_t LockstepChip8::step() {
+    if (regroup_) {
+        regroup();
+    }
+    auto const* pcs = pc_.data();
+    auto const* halted = halted_.data();
+    auto const* waiting = waiting_.data();
+    size_t executed = 0;
+    for (size_t g = 0; g < groups_; ++g) {
+        auto* first = members_.data() + groupStart_[g];
+        auto* last = members_.data() + groupStart_[g + 1];
+        int pc = pcs[*first];
+        int opcode = fetch(*first, pc);
+        bool split = false;
+        if (writtenPages_[pc >> 8] || writtenPages_[(pc + 1) >> 8]) {
+            // Lanes whose copy of the opcode differs run it alone and leave
+            // the group.
+            auto* kept = first + 1;
+            for (auto* lane = first + 1; lane != last; ++lane) {
+                int own = fetch(*lane, pc);
+                if (own == opcode) {
+                    *kept++ = *lane;
+                } else {
+                    executeScalar(*lane, own);
+                    ++scalarInstructions_;
+                    ++executed;
+                    split = true;
+                }
+            }
+            last = kept;
+            regroup_ |= split;
+        }
+
+        size_t members = last - first;
+        if (members > 1 && !split && isVectorizable(opcode)) {
+            executeVector(opcode, &masks_[groupMask_[g]]);
+            vectorInstructions_ += members;
+        } else {
+            for (auto* lane = first; lane != last; ++lane) {
+                executeScalar(*lane, opcode);
+            }
+            scalarInstructions_ += members;
+        }
+        executed += members;
+
+        // Anything else moves the whole group on by one instruction.
+        if (mayJump(opcode)) {
+            regroup_ |= groups_ > 1;
+            for (auto* lane = first; lane != last && !regroup_; ++lane) {
+                regroup_ = pcs[*lane] != pcs[*first] || halted[*lane];
+            }
+        }
+        regroup_ |= halted[*first] || waiting[*first];
+    }
+    return executed;
+}
+
+// Buckets the runnable lanes by pc, in order of their lowest lane.
+void LockstepChip8::regroup() {
+    auto* groupAt = groupAt_.data();
+    auto* groupOf = groupOf_.data();
+    auto* groupStart = groupStart_.data();
+    groups_ = 0;
+    for (size_t lane = 0; lane < lanes_; ++lane) {
+        if (halted_[lane] || waiting_[lane]) {
+            continue;
+        }
+        auto& slot = groupAt[pc_[lane]];
+        if (!slot) {
+            slot = static_cast<uint32_t>(++groups_);
+            groupStart[groups_] = 0;
+        }
+        groupOf[lane] = slot - 1;
+        ++groupStart[slot];
+    }
+    // Counts to ends; placing the lanes from the back moves each end down
+    // to its group's start, one slot to the right of where it belongs.
+    groupStart[0] = 0;
+    for (size_t g = 0; g < groups_; ++g) {
+        groupStart[g + 1] += groupStart[g];
+    }
+    auto live = groupStart[groups_];
+    for (size_t lane = lanes_; lane-- > 0;) {
+        if (!halted_[lane] && !waiting_[lane]) {
+            members_[--groupStart[groupOf[lane] + 1]] = static_cast<uint32_t>(lane);
+        }
+    }
+    for (size_t g = 0; g < groups_; ++g) {
+        groupStart[g] = groupStart[g + 1];
+        groupAt[pc_[members_[groupStart[g]]]] = 0;
+    }
+    groupStart[groups_] = live;
+    // Single lanes always run scalar and need no mask.
+    size_t mask = 0;
+    for (size_t g = 0; g < groups_; ++g) {
+        if (groupStart[g + 1] - groupStart[g] > 1) {
+            groupMask_[g] = mask;
+            std::fill_n(&masks_[mask], stride_, 0);
+            for (auto i = groupStart[g]; i < groupStart[g + 1]; ++i) {
+                masks_[mask + members_[i]] = 0xff;
+            }
+            mask += stride_;
+        }
+    }
+    regroup_ = false;
+}
+
+int LockstepChip8::fetch(size_t lane, int pc) const {
+    if (pc + 1 >= static_cast<int>(MEM_SIZE)) {
+        throw std::runtime_error("pc out of memory: " + std::to_string(pc));
+    }
+    auto const* memory = laneMemory(lane);
+    return (memory[pc] << 8) | memory[pc + 1];
+}
+
+bool LockstepChip8::isVectorizable(int opcode) const {
+    switch (opcode >> 12) {
+    case 0x1:
+    case 0x3:
+    case 0x4:
+    case 0x5:
+    case 0x6:
+    case 0x7:
+    case 0x9:
+    case 0xa:
+        return true;
+    case 0x8:
+        switch (opcode & 0xf) {
+        case 0x0: case 0x1: case 0x2: case 0x3:
+        case 0x4: case 0x5: case 0x6: case 0x7: case 0xe:
+            return true;
+        default:
+            return false;
+        }
+    default:
+        return false;
+    }
+}
+
+// Runs `opcode` at once on every lane whose `group` byte is 0xff. All
+// members share the pc, so jumps and Annn reduce to a masked store of one
+// value.
+void LockstepChip8::executeVector(int opcode, uint8_t const* group) {
+    int x = arg(opcode, 1);
+    int y = arg(opcode, 2);
+    auto kk = static_cast<uint8_t>(opcode & 0xff);
+    int nnn = opcode & 0xfff;
+    auto& vx = v_[x];
+    auto& vy = v_[y];
+    auto& vf = v_[FLAG_REGISTER];
+    auto one = Bytes::splat(1);
+    size_t const stride = stride_;
+
+    switch (opcode >> 12) {
+    case 0x1:
+    {
+        auto* pcs = pc_.data();
+        auto* halted = halted_.data();
+        for (size_t lane = 0; lane < stride; ++lane) {
+            halted[lane] |= group[lane] & (pcs[lane] == nnn);
+            pcs[lane] = group[lane] ? static_cast<uint16_t>(nnn) : pcs[lane];
+        }
+        return;
+    }
+    case 0xa:
+    {
+        auto* regI = regI_.data();
+        for (size_t lane = 0; lane < stride; ++lane) {
+            regI[lane] = group[lane] ? static_cast<uint16_t>(nnn) : regI[lane];
+        }
+        break;
+    }
+    case 0x3:
+    case 0x4:
+    case 0x5:
+    case 0x9:
+        for (size_t lane = 0; lane < stride; lane += Bytes::WIDTH) {
+            auto mask = Bytes::load(group + lane);
+            auto rhs = (opcode >> 12) == 0x3 || (opcode >> 12) == 0x4 ? Bytes::splat(kk) : Bytes::load(&vy[lane]);
+            auto eq = equal(Bytes::load(&vx[lane]), rhs);
+            auto skip = (opcode >> 12) == 0x3 || (opcode >> 12) == 0x5 ? eq : andNot(eq, mask);
+            (mask & skip).store(&skip_[lane]);
+        }
+        advancePc(group, skip_.data());
+        return;
+    case 0x6:
+        for (size_t lane = 0; lane < stride; lane += Bytes::WIDTH) {
+            auto mask = Bytes::load(group + lane);
+            select(mask, Bytes::splat(kk), Bytes::load(&vx[lane])).store(&vx[lane]);
+        }
+        break;
+    case 0x7:
+        for (size_t lane = 0; lane < stride; lane += Bytes::WIDTH) {
+            auto mask = Bytes::load(group + lane);
+            auto value = Bytes::load(&vx[lane]);
+            select(mask, value + Bytes::splat(kk), value).store(&vx[lane]);
+        }
+        break;
+    case 0x8:
+        for (size_t lane = 0; lane < stride; lane += Bytes::WIDTH) {
+            auto mask = Bytes::load(group + lane);
+            auto a = Bytes::load(&vx[lane]);
+            auto b = Bytes::load(&vy[lane]);
+            // Same order as applyAlu: VF first, then Vx from the registers as
+            // they are after the flag write (x or y may be F).
+            bool flags = true;
+            Bytes flag{};
+            switch (opcode & 0xf) {
+            case 0x4: flag = andNot(equal(maxU(a + b, a), a + b), one); break;
+            case 0x5: flag = equal(maxU(a, b), a) & one; break;
+            case 0x6: flag = a & one; break;
+            case 0x7: flag = equal(maxU(b, a), b) & one; break;
+            case 0xe: flag = equal(maxU(a, Bytes::splat(0x80)), a) & one; break;
+            default: flags = false; break;
+            }
+            if (flags) {
+                select(mask, flag, Bytes::load(&vf[lane])).store(&vf[lane]);
+                a = Bytes::load(&vx[lane]);
+                b = Bytes::load(&vy[lane]);
+            }
+            Bytes result{};
+            switch (opcode & 0xf) {
+            case 0x0: result = b; break;
+            case 0x1: result = a | b; break;
+            case 0x2: result = a & b; break;
+            case 0x3: result = a ^ b; break;
+            case 0x4: result = a + b; break;
+            case 0x5: result = a - b; break;
+            case 0x6: result = shiftRight1(a); break;
+            case 0x7: result = b - a; break;
+            case 0xe: result = a + a; break;
+            }
+            select(mask, result, a).store(&vx[lane]);
+        }
+        break;
+    }
+    std::fill(begin(skip_), end(skip_), 0);
+    advancePc(group, skip_.data());
+}
+
+// pc += 2, or 4 where `skip` is set, for every lane of the group.
+void LockstepChip8::advancePc(uint8_t const* group, uint8_t const* skip) {
+    auto* pcs = pc_.data();
+    auto* halted = halted_.data();
+    size_t const stride = stride_;
+    // 16-bit compare so that the loop vectorizes.
+    constexpr uint16_t lastPc = MEM_SIZE - 1;
+    for (size_t lane = 0; lane < stride; ++lane) {
+        pcs[lane] += group[lane] & (2 + (skip[lane] & 2));
+        halted[lane] |= pcs[lane] >= lastPc;
+    }
+}
+
+void LockstepChip8::executeScalar(size_t lane, int opcode) {
+    LaneRegisters v{ v_, lane };
+    auto* memory = laneMemory(lane);
+    auto* stack = &stack_[lane * STACK_DEPTH];
+    auto& sp = sp_[lane];
+    auto& pc = pc_[lane];
+    auto& regI = regI_[lane];
+    int x = arg(opcode, 1);
+    int y = arg(opcode, 2);
+    int kk = opcode & 0xff;
+    int nnn = opcode & 0xfff;
+    // Same wrap-around as FakeChip8::memoryAt.
+    auto memoryAt = [memory](size_t address) -> uint8_t& { return memory[address & (MEM_SIZE - 1)]; };
+
+    int oldPc = pc;
+    pc += 2;
+    switch (opcode >> 12) {
+    case 0x0:
+        if (opcode == 0x00E0) {
+            std::fill_n(begin(display_) + lane * DISPLAY_ROWS, DISPLAY_ROWS, 0);
+        } else if (opcode == 0x00EE) {
+            if (sp == 0) {
+                throw std::runtime_error("return with an empty stack at " + std::to_string(oldPc));
+            }
+            pc = stack[--sp];
+        } else {
+            pc = nnn;
+        }
+        break;
+    case 0x1:
+        pc = nnn;
+        halted_[lane] |= oldPc == nnn;
+        break;
+    case 0x2:
+        if (sp == STACK_DEPTH) {
+            throw std::runtime_error("stack overflow at " + std::to_string(oldPc));
+        }
+        stack[sp++] = pc;
+        pc = nnn;
+        break;
+    case 0x3:
+        pc += v[x] == kk ? 2 : 0;
+        break;
+    case 0x4:
+        pc += v[x] != kk ? 2 : 0;
+        break;
+    case 0x5:
+        pc += v[x] == v[y] ? 2 : 0;
+        break;
+    case 0x6:
+        v[x] = kk;
+        break;
+    case 0x7:
+        v[x] += kk;
+        break;
+    case 0x8:
+        applyAlu<Quirks>(v, opcode);
+        break;
+    case 0x9:
+        pc += v[x] != v[y] ? 2 : 0;
+        break;
+    case 0xa:
+        regI = nnn;
+        break;
+    case 0xb:
+        pc = v[0] + nnn;
+        break;
+    case 0xc:
+        v[x] = nextRandomByte(random_[lane]) & kk;
+        break;
+    case 0xd:
+    {
+        int col = v[x] % 64;
+        int row = v[y] % 32;
+        int n = arg(opcode, 3);
+        uint64_t lines[MAX_SPRITE_LINES];
+        size_t count = loadSprite(memory, MEM_SIZE, regI, n, lines);
+        v[FLAG_REGISTER] = blitSprite(&display_[lane * DISPLAY_ROWS], lines, count, col, row, Quirks::spriteEdge).collision;
+        break;
+    }
+    case 0xe:
+    {
+        bool pressed = (keys_[lane] >> (v[x] & 0xf)) & 1;
+        if ((kk == 0x9E && pressed) || (kk == 0xA1 && !pressed)) {
+            pc += 2;
+        }
+        break;
+    }
+    case 0xf:
+        switch (kk) {
+        case 0x07:
+            v[x] = delay_[lane];
+            break;
+        case 0x0a:
+            waiting_[lane] = 1;
+            waitRegister_[lane] = static_cast<uint8_t>(x);
+            break;
+        case 0x15:
+            delay_[lane] = v[x];
+            break;
+        case 0x18:
+            sound_[lane] = v[x];
+            break;
+        case 0x1e:
+            regI += v[x];
+            break;
+        case 0x29:
+            regI = v[x] * 5;
+            break;
+        case 0x33:
+            memoryAt(regI) = v[x] / 100;
+            memoryAt(regI + 1) = v[x] / 10 % 10;
+            memoryAt(regI + 2) = v[x] % 10;
+            markWritten(regI, 3);
+            break;
+        case 0x55:
+            for (int i = 0; i <= x; ++i) {
+                memoryAt(regI + i) = v[i];
+            }
+            markWritten(regI, x + 1);
+            break;
+        case 0x65:
+            for (int i = 0; i <= x; ++i) {
+                v[i] = memoryAt(regI + i);
+            }
+            break;
+        }
+        break;
+    }
+    halted_[lane] |= static_cast<size_t>(pc) + 1 >= MEM_SIZE;
+}
+
+void LockstepChip8::markWritten(size_t address, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        writtenPages_.set(((address + i) & (MEM_SIZE - 1)) >> 8);
+    }
+}
+
+} // namespace fakers
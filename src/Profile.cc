@@ -0,0 +1,120 @@
+#include "Profile.h"
+
+#include <fstream>
+#include <stdexcept>
+
+namespace fakers
+{
+namespace
+{
+std::string hex(size_t value) {
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    std::string text;
+    do {
+        text.insert(begin(text), DIGITS[value & 0xf]);
+        value >>= 4;
+    } while (value);
+    return "0x" + text;
+}
+
+// Calls f(kind, key, count) for every counter worth reporting.
+template <typename F>
+void forEachCounter(ProfileCounters const& profile, F&& f) {
+    f("total", "instructions", profile.instructions());
+    f("total", "keyWaitCycles", profile.keyWaitCycles);
+    f("total", "draws", profile.draws);
+    f("total", "collisions", profile.collisions);
+    auto families = profile.families();
+    for (size_t family = 0; family < families.size(); ++family) {
+        f("family", hex(family), families[family]);
+    }
+    auto ops = profile.ops();
+    for (size_t op = 0; op < ops.size(); ++op) {
+        if (ops[op]) {
+            f("op", opInfo(static_cast<Op>(op)).name, ops[op]);
+        }
+    }
+    for (size_t address = 0; address < profile.addresses.size(); ++address) {
+        if (profile.addresses[address]) {
+            f("address", hex(address), profile.addresses[address]);
+        }
+    }
+}
+
+} // namespace
+
+void ProfileCounters::reset() {
+    opcodes.fill(0);
+    addresses.fill(0);
+    keyWaitCycles = 0;
+    draws = 0;
+    collisions = 0;
+}
+
+uint64_t ProfileCounters::instructions() const {
+    uint64_t total = 0;
+    for (auto count : opcodes) {
+        total += count;
+    }
+    return total;
+}
+
+std::array<uint64_t, 16> ProfileCounters::families() const {
+    std::array<uint64_t, 16> families{};
+    for (size_t opcode = 0; opcode < SLOTS; ++opcode) {
+        families[opcode >> 12] += opcodes[opcode];
+    }
+    return families;
+}
+
+std::array<uint64_t, static_cast<size_t>(Op::Count)> ProfileCounters::ops() const {
+    std::array<uint64_t, static_cast<size_t>(Op::Count)> ops{};
+    for (size_t opcode = 0; opcode < SLOTS; ++opcode) {
+        if (opcodes[opcode]) {
+            ops[static_cast<size_t>(decodeOp(static_cast<int>(opcode), extended, xo))] += opcodes[opcode];
+        }
+    }
+    return ops;
+}
+
+void writeProfileJson(std::ostream& os, ProfileCounters const& profile) {
+    std::string section;
+    os << "{";
+    forEachCounter(profile, [&](std::string const& kind, std::string const& key, uint64_t count) {
+        if (kind == "total") {
+            os << (section.empty() ? "" : ",") << "\n  \"" << key << "\": " << count;
+            section = kind;
+            return;
+        }
+        if (kind != section) {
+            os << (section == "total" ? "" : "\n  }") << ",\n  \"" << kind << "\": {";
+            section = kind;
+        } else {
+            os << ",";
+        }
+        os << "\n    \"" << key << "\": " << count;
+    });
+    os << (section == "total" ? "" : "\n  }") << "\n}\n";
+}
+
+void writeProfileCsv(std::ostream& os, ProfileCounters const& profile) {
+    os << "kind,key,count\n";
+    forEachCounter(profile, [&](std::string const& kind, std::string const& key, uint64_t count) {
+        os << kind << ',' << key << ',' << count << '\n';
+    });
+}
+
+void writeProfile(std::string const& path, ProfileCounters const& profile) {
+    std::ofstream os{ path };
+    if (!os) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    if (json) {
+        writeProfileJson(os, profile);
+    } else {
+        writeProfileCsv(os, profile);
+    }
+}
+
+} // namespace fakers
@@ -0,0 +1,300 @@
+#include "ReferenceChip8.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace fakers
+{
+namespace
+{
+constexpr uint8_t FONT[80] =
+{
+    0xF0, 0x90, 0x90, 0x90, 0xF0, //0
+    0x20, 0x60, 0x20, 0x20, 0x70, //1
+    0xF0, 0x10, 0xF0, 0x80, 0xF0, //2
+    0xF0, 0x10, 0xF0, 0x10, 0xF0, //3
+    0x90, 0x90, 0xF0, 0x10, 0x10, //4
+    0xF0, 0x80, 0xF0, 0x10, 0xF0, //5
+    0xF0, 0x80, 0xF0, 0x90, 0xF0, //6
+    0xF0, 0x10, 0x20, 0x40, 0x40, //7
+    0xF0, 0x90, 0xF0, 0x90, 0xF0, //8
+    0xF0, 0x90, 0xF0, 0x10, 0xF0, //9
+    0xF0, 0x90, 0xF0, 0x90, 0x90, //A
+    0xE0, 0x90, 0xE0, 0x90, 0xE0, //B
+    0xF0, 0x80, 0x80, 0x80, 0xF0, //C
+    0xE0, 0x90, 0x90, 0x90, 0xE0, //D
+    0xF0, 0x80, 0xF0, 0x80, 0xF0, //E
+    0xF0, 0x80, 0xF0, 0x80, 0x80  //F
+};
+
+constexpr int VF = 0xf;
+constexpr int COLUMNS = 64;
+constexpr int ROWS = static_cast<int>(DISPLAY_ROWS);
+
+} // namespace
+
+template <typename Quirks>
+void ReferenceChip8<Quirks>::load(uint8_t const* program, size_t size, uint64_t seed) {
+    if (size > MEM_SIZE - MEM_START) {
+        throw std::runtime_error("program does not fit in memory: " + std::to_string(size));
+    }
+    state_ = MachineState{};
+    state_.pc = MEM_START;
+    state_.random = seedRandom(seed);
+    for (size_t i = 0; i < sizeof(FONT); ++i) {
+        state_.memory[i] = FONT[i];
+    }
+    for (size_t i = 0; i < size; ++i) {
+        state_.memory[MEM_START + i] = program[i];
+    }
+    keys_.reset();
+    halted_ = false;
+}
+
+template <typename Quirks>
+bool ReferenceChip8<Quirks>::step(std::bitset<16> keys) {
+    keys_ = keys;
+    if (state_.waitingForKey) {
+        if (keys.none()) {
+            return !halted_;
+        }
+        // The highest key held wins.
+        for (int key = 0; key < 16; ++key) {
+            if (keys[key]) {
+                state_.v[state_.keyRegister] = static_cast<uint8_t>(key);
+            }
+        }
+        state_.waitingForKey = false;
+    }
+    int opcode = state_.memory[state_.pc] << 8 | state_.memory[state_.pc + 1];
+    state_.pc += 2;
+    execute(opcode);
+    return !halted();
+}
+
+template <typename Quirks>
+void ReferenceChip8<Quirks>::tickTimers() {
+    if (state_.delayTimer > 0) {
+        --state_.delayTimer;
+    }
+    if (state_.soundTimer > 0) {
+        --state_.soundTimer;
+    }
+}
+
+template <typename Quirks>
+void ReferenceChip8<Quirks>::execute(int opcode) {
+    auto& v = state_.v;
+    int x = (opcode >> 8) & 0xf;
+    int y = (opcode >> 4) & 0xf;
+    int n = opcode & 0xf;
+    int kk = opcode & 0xff;
+    int nnn = opcode & 0xfff;
+    int at = state_.pc - 2;
+    switch (opcode >> 12) {
+    case 0x0:
+        if (opcode == 0x00E0) {
+            state_.display = {};
+        } else if (opcode == 0x00EE) {
+            if (state_.sp == 0) {
+                throw std::runtime_error("return with an empty stack at " + std::to_string(at));
+            }
+            --state_.sp;
+            state_.pc = state_.stack[state_.sp];
+        } else {
+            // 0nnn: there is no 1802 to call into, so it is a jump.
+            state_.pc = static_cast<uint16_t>(nnn);
+        }
+        break;
+    case 0x1:
+        // Jumping onto itself is how programs end.
+        halted_ = halted_ || nnn == at;
+        state_.pc = static_cast<uint16_t>(nnn);
+        break;
+    case 0x2:
+        if (state_.sp == STACK_DEPTH) {
+            throw std::runtime_error("stack overflow at " + std::to_string(at));
+        }
+        state_.stack[state_.sp] = state_.pc;
+        ++state_.sp;
+        state_.pc = static_cast<uint16_t>(nnn);
+        break;
+    case 0x3:
+        if (v[x] == kk) {
+            state_.pc += 2;
+        }
+        break;
+    case 0x4:
+        if (v[x] != kk) {
+            state_.pc += 2;
+        }
+        break;
+    case 0x5:
+        // The low nibble is not decoded: 5xy1-5xyF compare like 5xy0.
+        if (v[x] == v[y]) {
+            state_.pc += 2;
+        }
+        break;
+    case 0x6:
+        v[x] = static_cast<uint8_t>(kk);
+        break;
+    case 0x7:
+        v[x] = static_cast<uint8_t>(v[x] + kk);
+        break;
+    case 0x8:
+        alu(opcode);
+        break;
+    case 0x9:
+        if (v[x] != v[y]) {
+            state_.pc += 2;
+        }
+        break;
+    case 0xA:
+        state_.regI = static_cast<uint16_t>(nnn);
+        break;
+    case 0xB:
+        state_.pc = static_cast<uint16_t>(nnn + v[Quirks::jumpUsesVx ? x : 0]);
+        break;
+    case 0xC:
+        v[x] = nextRandomByte(state_.random) & kk;
+        break;
+    case 0xD:
+        draw(v[x], v[y], n);
+        break;
+    case 0xE:
+        if ((kk == 0x9E && keys_[v[x] & 0xf]) || (kk == 0xA1 && !keys_[v[x] & 0xf])) {
+            state_.pc += 2;
+        }
+        break;
+    case 0xF:
+        switch (kk) {
+        case 0x07:
+            v[x] = state_.delayTimer;
+            break;
+        case 0x0A:
+            state_.waitingForKey = true;
+            state_.keyRegister = static_cast<uint8_t>(x);
+            break;
+        case 0x15:
+            state_.delayTimer = v[x];
+            break;
+        case 0x18:
+            state_.soundTimer = v[x];
+            break;
+        case 0x1E:
+            state_.regI = static_cast<uint16_t>(state_.regI + v[x]);
+            break;
+        case 0x29:
+            state_.regI = static_cast<uint16_t>(v[x] * 5);
+            break;
+        case 0x33:
+            memoryAt(state_.regI) = v[x] / 100;
+            memoryAt(state_.regI + 1) = v[x] / 10 % 10;
+            memoryAt(state_.regI + 2) = v[x] % 10;
+            break;
+        case 0x55:
+        case 0x65:
+            for (int i = 0; i <= x; ++i) {
+                if (kk == 0x55) {
+                    memoryAt(state_.regI + i) = v[i];
+                } else {
+                    v[i] = memoryAt(state_.regI + i);
+                }
+            }
+            if (Quirks::loadStoreIncrement == IndexIncrement::ByX) {
+                state_.regI = static_cast<uint16_t>(state_.regI + x);
+            } else if (Quirks::loadStoreIncrement == IndexIncrement::ByXPlusOne) {
+                state_.regI = static_cast<uint16_t>(state_.regI + x + 1);
+            }
+            break;
+        }
+        break;
+    }
+}
+
+// The flag is computed from Vx and Vy as they were. The legacy profile then
+// writes VF before computing Vx from the registers again, so x or y being F
+// sees the flag; the others write Vx first and VF last.
+template <typename Quirks>
+void ReferenceChip8<Quirks>::alu(int opcode) {
+    auto& v = state_.v;
+    int x = (opcode >> 8) & 0xf;
+    int y = (opcode >> 4) & 0xf;
+    int n = opcode & 0xf;
+    struct Outcome {
+        int value;
+        int flag;
+    };
+    constexpr int NO_FLAG = -1;
+    auto compute = [n, opcode](int vx, int vy) -> Outcome {
+        int source = Quirks::shiftUsesVy ? vy : vx;
+        int logicFlag = Quirks::logicResetsVf ? 0 : NO_FLAG;
+        switch (n) {
+        case 0x0: return { vy, NO_FLAG };
+        case 0x1: return { vx | vy, logicFlag };
+        case 0x2: return { vx & vy, logicFlag };
+        case 0x3: return { vx ^ vy, logicFlag };
+        case 0x4: return { (vx + vy) & 0xff, vx + vy > 0xff };
+        case 0x5: return { (vx - vy) & 0xff, vx >= vy };
+        case 0x6: return { source >> 1, source & 1 };
+        case 0x7: return { (vy - vx) & 0xff, vy >= vx };
+        case 0xE: return { (source << 1) & 0xff, source >> 7 };
+        }
+        throw std::runtime_error("undefined ALU opcode " + std::to_string(opcode));
+    };
+    Outcome outcome = compute(v[x], v[y]);
+    if (!Quirks::flagWrittenLast && outcome.flag != NO_FLAG) {
+        v[VF] = static_cast<uint8_t>(outcome.flag);
+        outcome.value = compute(v[x], v[y]).value;
+    }
+    v[x] = static_cast<uint8_t>(outcome.value);
+    if (Quirks::flagWrittenLast && outcome.flag != NO_FLAG) {
+        v[VF] = static_cast<uint8_t>(outcome.flag);
+    }
+}
+
+// Sprite rows come from I on, up to the end of memory. Each set bit flips
+// one pixel; pixels past the right or bottom edge are clipped or wrapped as
+// the profile says.
+template <typename Quirks>
+void ReferenceChip8<Quirks>::draw(int vx, int vy, int n) {
+    int left = vx % COLUMNS;
+    int top = vy % ROWS;
+    bool wrap = Quirks::spriteEdge == SpriteEdge::Wrap;
+    state_.v[VF] = 0;
+    for (int line = 0; line < n && state_.regI + line < static_cast<int>(MEM_SIZE); ++line) {
+        int row = top + line;
+        if (row >= ROWS) {
+            if (!wrap) {
+                break;
+            }
+            row -= ROWS;
+        }
+        uint8_t bits = state_.memory[state_.regI + line];
+        for (int bit = 0; bit < 8; ++bit) {
+            if (!(bits & (0x80 >> bit))) {
+                continue;
+            }
+            int column = left + bit;
+            if (column >= COLUMNS) {
+                if (!wrap) {
+                    continue;
+                }
+                column -= COLUMNS;
+            }
+            uint64_t pixel = 1ull << (63 - column);
+            if (state_.display[row] & pixel) {
+                state_.v[VF] = 1;
+            }
+            state_.display[row] ^= pixel;
+        }
+    }
+}
+
+template class ReferenceChip8<LegacyQuirks>;
+template class ReferenceChip8<CosmacVipQuirks>;
+template class ReferenceChip8<Chip48Quirks>;
+template class ReferenceChip8<SuperChipQuirks>;
+template class ReferenceChip8<XoChipQuirks>;
+
+} // namespace fakers
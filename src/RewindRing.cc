@@ -0,0 +1,86 @@
+#include "RewindRing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+namespace fakers
+{
+void RewindRing::capture(uint64_t frame, MachineState const& state) {
+    if (frame % std::max<uint32_t>(config_.framesPerSnapshot, 1) != 0 || (!entries_.empty() && entries_.back().frame == frame)) {
+        return;
+    }
+    Entry entry;
+    entry.frame = frame;
+    entry.head = { state.v, state.pc, state.regI, state.delayTimer, state.soundTimer, state.sp, state.keyRegister,
+        state.waitingForKey, state.hiRes, state.planeMask, state.flags, state.random, state.stack, state.display };
+    Entry const* previous = entries_.empty() ? nullptr : &entries_.back();
+    for (size_t page = 0; page < PAGE_COUNT; ++page) {
+        auto const* bytes = state.memory.data() + page * PAGE_SIZE;
+        if (previous && std::memcmp(previous->pages[page]->data(), bytes, PAGE_SIZE) == 0) {
+            entry.pages[page] = previous->pages[page];
+        } else {
+            auto copy = std::make_shared<Page>();
+            std::memcpy(copy->data(), bytes, PAGE_SIZE);
+            entry.pages[page] = std::move(copy);
+        }
+    }
+    entries_.push_back(std::move(entry));
+    if (entries_.size() > config_.capacity) {
+        entries_.pop_front();
+    }
+}
+
+uint64_t RewindRing::frame(size_t stepsBack) const {
+    return entry(stepsBack).frame;
+}
+
+MachineState RewindRing::restore(size_t stepsBack) const {
+    auto const& source = entry(stepsBack);
+    auto const& head = source.head;
+    MachineState state;
+    state.v = head.v;
+    state.pc = head.pc;
+    state.regI = head.regI;
+    state.delayTimer = head.delayTimer;
+    state.soundTimer = head.soundTimer;
+    state.sp = head.sp;
+    state.keyRegister = head.keyRegister;
+    state.waitingForKey = head.waitingForKey;
+    state.hiRes = head.hiRes;
+    state.planeMask = head.planeMask;
+    state.flags = head.flags;
+    state.random = head.random;
+    state.stack = head.stack;
+    state.display = head.display;
+    for (size_t page = 0; page < PAGE_COUNT; ++page) {
+        std::memcpy(state.memory.data() + page * PAGE_SIZE, source.pages[page]->data(), PAGE_SIZE);
+    }
+    return state;
+}
+
+void RewindRing::truncate(size_t stepsBack) {
+    entry(stepsBack);
+    entries_.erase(entries_.end() - stepsBack, entries_.end());
+}
+
+size_t RewindRing::memoryBytes() const {
+    std::unordered_set<Page const*> pages;
+    for (auto const& entry : entries_) {
+        for (auto const& page : entry.pages) {
+            pages.insert(page.get());
+        }
+    }
+    return entries_.size() * sizeof(Entry) + pages.size() * sizeof(Page);
+}
+
+RewindRing::Entry const& RewindRing::entry(size_t stepsBack) const {
+    if (stepsBack >= entries_.size()) {
+        throw std::runtime_error("no snapshot " + std::to_string(stepsBack) + " steps back");
+    }
+    return entries_[entries_.size() - 1 - stepsBack];
+}
+
+} // namespace fakers
@@ -0,0 +1,213 @@
+#include "RomLibrary.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "StateHash.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fakers
+{
+namespace
+{
+uint64_t get(uint8_t const* bytes, int count) {
+    uint64_t value = 0;
+    for (int i = 0; i < count; ++i) {
+        value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+void put(std::ostream& os, uint64_t value, int count) {
+    for (int i = 0; i < count; ++i) {
+        os.put(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+constexpr size_t PACK_HEADER_SIZE = sizeof(ROM_PACK_MAGIC) + 4 + 4;
+// Offset, size and name length.
+constexpr size_t PACK_ENTRY_SIZE = 4 + 4 + 2;
+
+} // namespace
+
+#ifdef _WIN32
+MappedFile::MappedFile(std::string const& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_) {
+        // The view keeps the file mapped once both handles are closed.
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        data_ = mapping ? static_cast<uint8_t const*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+    if (size_ && !data_) {
+        throw std::runtime_error("cannot map " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+}
+#else
+MappedFile::MappedFile(std::string const& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) == 0) {
+        size_ = static_cast<size_t>(info.st_size);
+    }
+    // mmap rejects empty mappings; an empty file simply has no data.
+    if (size_) {
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        data_ = data == MAP_FAILED ? nullptr : static_cast<uint8_t const*>(data);
+    }
+    ::close(fd);
+    if (size_ && !data_) {
+        throw std::runtime_error("cannot map " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+}
+#endif
+
+void RomLibrary::add(std::string const& path) {
+    namespace fs = std::filesystem;
+    if (fs::is_directory(path)) {
+        std::vector<fs::path> files;
+        for (auto const& entry : fs::directory_iterator(path)) {
+            if (entry.is_regular_file()) {
+                files.push_back(entry.path());
+            }
+        }
+        std::sort(begin(files), end(files));
+        for (auto const& file : files) {
+            auto const& mapped = map(file.string());
+            addRom(file.string(), mapped.data(), mapped.size());
+        }
+        return;
+    }
+    auto const& mapped = map(path);
+    if (mapped.size() >= sizeof(ROM_PACK_MAGIC)
+        && std::memcmp(mapped.data(), ROM_PACK_MAGIC, sizeof(ROM_PACK_MAGIC)) == 0) {
+        addPack(path, mapped);
+    } else {
+        addRom(path, mapped.data(), mapped.size());
+    }
+}
+
+RomEntry const* RomLibrary::find(std::string_view name) const {
+    auto it = std::find_if(begin(entries_), end(entries_), [&](RomEntry const& entry) { return entry.name == name; });
+    return it == end(entries_) ? nullptr : &*it;
+}
+
+MappedFile const& RomLibrary::map(std::string const& path) {
+    files_.push_back(std::make_unique<MappedFile>(path));
+    return *files_.back();
+}
+
+void RomLibrary::addPack(std::string const& path, MappedFile const& file) {
+    uint8_t const* data = file.data();
+    size_t size = file.size();
+    auto corrupt = [&path]() { return std::runtime_error("corrupt ROM pack " + path); };
+    if (size < PACK_HEADER_SIZE) {
+        throw corrupt();
+    }
+    auto version = get(data + sizeof(ROM_PACK_MAGIC), 4);
+    if (version != ROM_PACK_VERSION) {
+        throw std::runtime_error("unsupported ROM pack version " + std::to_string(version));
+    }
+    auto count = get(data + sizeof(ROM_PACK_MAGIC) + 4, 4);
+    size_t at = PACK_HEADER_SIZE;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (at + PACK_ENTRY_SIZE > size) {
+            throw corrupt();
+        }
+        size_t offset = get(data + at, 4);
+        size_t length = get(data + at + 4, 4);
+        size_t nameLength = get(data + at + 8, 2);
+        at += PACK_ENTRY_SIZE;
+        if (at + nameLength > size || offset > size || length > size - offset) {
+            throw corrupt();
+        }
+        addRom(std::string{ reinterpret_cast<char const*>(data + at), nameLength }, data + offset, length);
+        at += nameLength;
+    }
+}
+
+void RomLibrary::addRom(std::string name, uint8_t const* data, size_t size) {
+    if (size == 0) {
+        rejected_.push_back({ std::move(name), "empty" });
+        return;
+    }
+    if (size > maxProgramSize_) {
+        rejected_.push_back({ std::move(name),
+            std::to_string(size) + " bytes, more than " + std::to_string(maxProgramSize_) });
+        return;
+    }
+    StateHash hash;
+    for (size_t i = 0; i < size; ++i) {
+        hash.add(data[i], 1);
+    }
+    entries_.push_back({ std::move(name), data, size, hash.value() });
+}
+
+void writeRomPack(std::string const& path, std::vector<RomEntry> const& entries) {
+    std::ofstream os{ path, std::ios::binary };
+    if (!os) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    os.write(ROM_PACK_MAGIC, sizeof(ROM_PACK_MAGIC));
+    put(os, ROM_PACK_VERSION, 4);
+    put(os, entries.size(), 4);
+    size_t offset = PACK_HEADER_SIZE;
+    for (auto const& entry : entries) {
+        if (entry.name.size() > UINT16_MAX) {
+            throw std::runtime_error("ROM name too long for a pack: " + entry.name);
+        }
+        offset += PACK_ENTRY_SIZE + entry.name.size();
+    }
+    for (auto const& entry : entries) {
+        if (offset + entry.size > UINT32_MAX) {
+            throw std::runtime_error("ROM pack larger than 4 GB");
+        }
+        put(os, offset, 4);
+        put(os, entry.size, 4);
+        put(os, entry.name.size(), 2);
+        os.write(entry.name.data(), entry.name.size());
+        offset += entry.size;
+    }
+    for (auto const& entry : entries) {
+        os.write(reinterpret_cast<char const*>(entry.data), entry.size);
+    }
+}
+
+} // namespace fakers
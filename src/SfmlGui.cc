@@ -9,16 +9,55 @@
 #include <future>
 #include <iterator>
 #include <memory>
-#include <mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
 
 #include "SfmlGui.h"
 namespace fakers
 {
+namespace
+{
+// Off, plane 0, plane 1 (XO-CHIP), both planes.
+constexpr uint8_t PALETTE[4][3] = {
+    { 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0xff },
+    { 0xff, 0x40, 0x40 },
+    { 0xff, 0x00, 0xff },
+};
+
+constexpr size_t HIRES_ROWS = std::tuple_size_v<HiResFramebuffer>;
+
+sf::Color paletteColor(int index) {
+    return { PALETTE[index][0], PALETTE[index][1], PALETTE[index][2] };
+}
+
+int pixelAt(GuiFrame const& frame, size_t row, size_t column) {
+    int shift = 63 - static_cast<int>(column % 64);
+    return (frame.planes[0][row][column / 64] >> shift & 1) | (frame.planes[1][row][column / 64] >> shift & 1) << 1;
+}
+
+} // namespace
+
+Gui::Gui(Renderer renderer)
+    : renderer_(renderer), expander_({ rgba(PALETTE[0][0], PALETTE[0][1], PALETTE[0][2]),
+        rgba(PALETTE[1][0], PALETTE[1][1], PALETTE[1][2]), rgba(PALETTE[2][0], PALETTE[2][1], PALETTE[2][2]),
+        rgba(PALETTE[3][0], PALETTE[3][1], PALETTE[3][2]) }) {}
 
 void Gui::run() {
     using namespace std::chrono_literals;
     renderWindow_ = std::make_unique<sf::RenderWindow>(
         sf::VideoMode(windowSizeX, windowSizeY), "FakeChip8 - Emulator");
+    if (renderer_ == Renderer::Texture) {
+        // Plain 2D texture without mipmaps or shaders, so software GL
+        // implementations such as llvmpipe handle it as well.
+        if (!texture_.create(HIRES_COLUMNS, HIRES_ROWS)) {
+            throw std::runtime_error("cannot create framebuffer texture");
+        }
+        texture_.setSmooth(false);
+        pixels_.fill(rgba(0x00, 0x00, 0x00));
+        texture_.update(reinterpret_cast<sf::Uint8 const*>(pixels_.data()));
+    }
     sf::Font font;
     if (!font.loadFromFile("C:\\Windows\\Fonts\\consola.ttf")) {
         throw std::runtime_error("cannot load font");
@@ -28,145 +67,245 @@ void Gui::run() {
     text.setOutlineThickness(2.f);
     text.setFillColor(sf::Color::White);
     text.setOutlineColor(sf::Color::Blue);
+    // Resolution last drawn, and rows to rebuild because the rectangle size
+    // changed.
+    bool hiRes = false;
+    uint64_t resizedRows = 0;
     while (renderWindow_->isOpen()) {
-        // Process events
-        sf::Event event;
-        while (renderWindow_->pollEvent(event)) {
-            // Close window: exit
-            if (event.type == sf::Event::Closed) {
-                onExitHandler();
-                renderWindow_->close();
-            }
-            if (event.type == sf::Event::Resized) {
-                sf::Vector2u windowSize = renderWindow_->getSize();
-                sf::FloatRect visibleArea;
-                visibleArea.left = 0;
-                visibleArea.top = 0;
-                visibleArea.width = windowSize.x;
-                visibleArea.height = windowSize.y;
-
-                renderWindow_->setView(sf::View{ visibleArea });
-
-                windowSizeX = windowSize.x;
-                windowSizeY = windowSize.y;
-            }
-            if (event.type == sf::Event::KeyPressed) {
-                handleKeyPressed(event, true);
-            }
-            if (event.type == sf::Event::KeyReleased) {
-                handleKeyPressed(event, false);
-            }
-        }
+        pollEvents(resizedRows);
 
+        // The rows changed in every frame published since the last pass,
+        // including skipped ones. They are taken before the frame, so the
+        // frame is at least as new as all of them.
+        uint64_t rows = changedRows_.exchange(0, std::memory_order_acquire);
+        frames_.acquire();
+        auto const& frame = frames_.front();
+        if (frame.hiRes != hiRes) {
+            rows = ~0ull;
+            hiRes = frame.hiRes;
+        }
+        auto columns = frame.hiRes ? HIRES_COLUMNS : DISPLAY_COLUMNS;
+        auto height = frame.hiRes ? HIRES_ROWS : DISPLAY_ROWS;
         renderWindow_->clear();
-        {
-            const std::lock_guard lock{ drawingMutex_ };
-            for (auto const& rect : pixelRects_) {
-                renderWindow_->draw(rect);
+        if (renderer_ == Renderer::Texture) {
+            updateTexture(frame, rows);
+            sf::Sprite sprite{ texture_, sf::IntRect{ 0, 0, (int)columns, (int)height } };
+            sprite.setScale((float)windowSizeX / columns, (float)windowSizeY / height);
+            renderWindow_->draw(sprite);
+        } else {
+            rebuildRows(frame, rows | resizedRows);
+            for (auto const& rects : rowRects_) {
+                for (auto const& rect : rects) {
+                    renderWindow_->draw(rect);
+                }
             }
         }
+        resizedRows = 0;
         renderWindow_->draw(text);
         renderWindow_->display();
-        std::this_thread::sleep_for(15ms);
+        // Redraw every 15 ms but take key events every millisecond, so a
+        // press reaches the emulator without waiting for the next redraw.
+        auto redrawAt = std::chrono::steady_clock::now() + 15ms;
+        while (renderWindow_->isOpen() && std::chrono::steady_clock::now() < redrawAt) {
+            std::this_thread::sleep_for(1ms);
+            pollEvents(resizedRows);
+        }
+    }
+}
+
+void Gui::pollEvents(uint64_t& resizedRows) {
+    sf::Event event;
+    while (renderWindow_->pollEvent(event)) {
+        // Close window: exit
+        if (event.type == sf::Event::Closed) {
+            onExitHandler();
+            keys_.close();
+            renderWindow_->close();
+        }
+        if (event.type == sf::Event::Resized) {
+            sf::Vector2u windowSize = renderWindow_->getSize();
+            sf::FloatRect visibleArea;
+            visibleArea.left = 0;
+            visibleArea.top = 0;
+            visibleArea.width = windowSize.x;
+            visibleArea.height = windowSize.y;
+
+            renderWindow_->setView(sf::View{ visibleArea });
+
+            windowSizeX = windowSize.x;
+            windowSizeY = windowSize.y;
+            resizedRows = ~0ull;
+        }
+        if (event.type == sf::Event::KeyPressed) {
+            handleKeyPressed(event, true);
+        }
+        if (event.type == sf::Event::KeyReleased) {
+            handleKeyPressed(event, false);
+        }
     }
 }
 
 void Gui::handleKeyPressed(const sf::Event& event, bool isPressed) {
-    const std::lock_guard lock{ readingKeyMutex_ };
     switch (event.key.code) {
     case sf::Keyboard::Num1:
-        keyPressedState[1] = isPressed;
+        keys_.push(1, isPressed);
         break;
     case sf::Keyboard::Num2:
-        keyPressedState[2] = isPressed;
+        keys_.push(2, isPressed);
         break;
     case sf::Keyboard::Num3:
-        keyPressedState[3] = isPressed;
+        keys_.push(3, isPressed);
         break;
     case sf::Keyboard::Q:
-        keyPressedState[4] = isPressed;
+        keys_.push(4, isPressed);
         break;
     case sf::Keyboard::W:
-        keyPressedState[5] = isPressed;
+        keys_.push(5, isPressed);
         break;
     case sf::Keyboard::E:
-        keyPressedState[6] = isPressed;
+        keys_.push(6, isPressed);
         break;
     case sf::Keyboard::A:
-        keyPressedState[7] = isPressed;
+        keys_.push(7, isPressed);
         break;
     case sf::Keyboard::S:
-        keyPressedState[8] = isPressed;
+        keys_.push(8, isPressed);
         break;
     case sf::Keyboard::D:
-        keyPressedState[9] = isPressed;
+        keys_.push(9, isPressed);
         break;
     case sf::Keyboard::Z:
-        keyPressedState[0xa] = isPressed;
+        keys_.push(0xa, isPressed);
         break;
     case sf::Keyboard::X:
-        keyPressedState[0] = isPressed;
+        keys_.push(0, isPressed);
         break;
     case sf::Keyboard::C:
-        keyPressedState[0xb] = isPressed;
+        keys_.push(0xb, isPressed);
         break;
     case sf::Keyboard::Num4:
-        keyPressedState[0xc] = isPressed;
+        keys_.push(0xc, isPressed);
         break;
     case sf::Keyboard::R:
-        keyPressedState[0xd] = isPressed;
+        keys_.push(0xd, isPressed);
         break;
     case sf::Keyboard::F:
-        keyPressedState[0xe] = isPressed;
+        keys_.push(0xe, isPressed);
         break;
     case sf::Keyboard::V:
-        keyPressedState[0xf] = isPressed;
+        keys_.push(0xf, isPressed);
+        break;
+    case sf::Keyboard::BackSpace:
+        rewinding_ = isPressed;
         break;
     default:
         break;
     }
 }
 
-void Gui::draw(std::vector<uint64_t> const& graphic) {
-    std::vector<sf::RectangleShape> updated;
-    constexpr size_t maxSquaresOnAxisX = 64;
-    constexpr size_t maxSquaresOnAxisY = 32;
-
-    constexpr float outlineSize = 4;
-    constexpr float padding = outlineSize / 2.f;
-    constexpr float squareSizeBase = 100;
-    float ratioX = (float)windowSizeX / (float)windowSizeY;
-    float ratioY = (float)windowSizeY / (float)windowSizeX;
-    float squareSizeX = windowSizeX / ((float)maxSquaresOnAxisX);
-    float squareSizeY = windowSizeY / ((float)maxSquaresOnAxisY);
+// Runs on the emulator thread: brings the back slot up to date by copying
+// the rows it lacks, publishes it and hands the changed rows to the render
+// loop, never waiting on it.
+void Gui::update(Framebuffer const& graphic, uint32_t dirtyRows) {
+    auto& frame = frames_.back();
+    uint64_t stale = takeStaleRows(dirtyRows);
+    for (size_t i = 0; i < graphic.size(); ++i) {
+        if (stale & (1ull << i)) {
+            frame.planes[0][i][0] = graphic[i];
+        }
+    }
+    publish(dirtyRows);
+}
+
+void Gui::updateHiRes(HiResFramebuffer const* planes, size_t planeCount, uint64_t dirtyRows) {
+    auto& frame = frames_.back();
+    uint64_t stale = takeStaleRows(dirtyRows);
+    for (size_t plane = 0; plane < std::min(planeCount, frame.planes.size()); ++plane) {
+        for (size_t i = 0; i < HIRES_ROWS; ++i) {
+            if (stale & (1ull << i)) {
+                frame.planes[plane][i] = planes[plane][i];
+            }
+        }
+    }
+    frame.hiRes = true;
+    publish(dirtyRows);
+}
+
+// Each slot lacks the rows changed since it was last filled: the rows
+// changed now, plus those it missed while the other two slots were in use.
+uint64_t Gui::takeStaleRows(uint64_t dirtyRows) {
+    for (auto& rows : staleRows_) {
+        rows |= dirtyRows;
+    }
+    return std::exchange(staleRows_[frames_.backIndex()], 0);
+}
+
+// The rows are added after the frame is out, so the render loop, which
+// takes the rows before the frame, never clears rows of a frame it has not
+// got yet.
+void Gui::publish(uint64_t dirtyRows) {
+    frames_.publish();
+    changedRows_.fetch_or(dirtyRows, std::memory_order_release);
+}
+
+// Rebuilds the pixel rectangles of the given rows only; runs on the render
+// thread, once per host frame, however many draws the core made meanwhile.
+void Gui::rebuildRows(GuiFrame const& frame, uint64_t rows) {
+    size_t columns = frame.hiRes ? HIRES_COLUMNS : DISPLAY_COLUMNS;
+    size_t height = frame.hiRes ? HIRES_ROWS : DISPLAY_ROWS;
+
+    float outlineSize = frame.hiRes ? 2 : 4;
+    float padding = outlineSize / 2.f;
+    float squareSizeX = windowSizeX / ((float)columns);
+    float squareSizeY = windowSizeY / ((float)height);
     auto rectSize =
         sf::Vector2f{ squareSizeX - outlineSize, squareSizeY - outlineSize };
 
     sf::RectangleShape rectangle;
     rectangle.setOutlineColor(sf::Color::Cyan);
-    rectangle.setFillColor(sf::Color::Blue);
     rectangle.setOutlineThickness(outlineSize);
     rectangle.setSize(rectSize);
 
-    for (size_t i = 0; i < graphic.size(); ++i) {
-        std::bitset<64u> line{ graphic[i] };
-        for (size_t j = 0; j < maxSquaresOnAxisX; ++j) {
-            if (line[j]) {
-                auto x = (rectSize.x + outlineSize) * (float)(maxSquaresOnAxisX - j - 1);
+    for (size_t i = 0; i < rowRects_.size(); ++i) {
+        if (!(rows & (1ull << i))) {
+            continue;
+        }
+        auto& rects = rowRects_[i];
+        rects.clear();
+        if (i >= height) {
+            continue;
+        }
+        for (size_t j = 0; j < columns; ++j) {
+            if (int colour = pixelAt(frame, i, j)) {
+                auto x = (rectSize.x + outlineSize) * (float)j;
                 auto y = (rectSize.y + outlineSize) * (float)(i);
 
+                rectangle.setFillColor(paletteColor(colour));
                 rectangle.setPosition(sf::Vector2f(padding + x, padding + y));
-                updated.push_back(rectangle);
+                rects.push_back(rectangle);
             }
         }
     }
-    const std::lock_guard lock{ drawingMutex_ };
-    std::swap(updated, pixelRects_);
 }
 
-std::bitset<16> Gui::read() {
-    const std::lock_guard lock{ readingKeyMutex_ };
-    return keyPressedState;
+// Expands the changed rows into the pixel buffer and uploads it as one
+// texture; the sprite scales it to the window on the GPU (or llvmpipe).
+// Low resolution frames use the top-left 64x32 of the texture.
+void Gui::updateTexture(GuiFrame const& frame, uint64_t rows) {
+    if (!rows) {
+        return;
+    }
+    size_t words = frame.hiRes ? 2 : 1;
+    size_t height = frame.hiRes ? HIRES_ROWS : DISPLAY_ROWS;
+    for (size_t i = 0; i < height; ++i) {
+        if (rows & (1ull << i)) {
+            for (size_t word = 0; word < words; ++word) {
+                expander_.expandRow(frame.planes[0][i][word], frame.planes[1][i][word],
+                    &pixels_[i * HIRES_COLUMNS + 64 * word]);
+            }
+        }
+    }
+    texture_.update(reinterpret_cast<sf::Uint8 const*>(pixels_.data()));
 }
 
 void Gui::onExit(std::function<void()>&& handler) { onExitHandler = handler; }
@@ -0,0 +1,133 @@
+#include "Snapshot.h"
+
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace fakers
+{
+namespace
+{
+class BlobWriter {
+public:
+    explicit BlobWriter(std::vector<uint8_t>& blob) : blob_(blob) {}
+
+    void put(uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            blob_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    template <typename Container>
+    void putAll(Container const& values) {
+        for (auto value : values) {
+            put(value, sizeof(value));
+        }
+    }
+
+private:
+    std::vector<uint8_t>& blob_;
+};
+
+class BlobReader {
+public:
+    explicit BlobReader(std::vector<uint8_t> const& blob) : blob_(blob) {}
+
+    uint64_t get(int bytes) {
+        if (offset_ + bytes > blob_.size()) {
+            throw std::runtime_error("truncated snapshot");
+        }
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(blob_[offset_++]) << (8 * i);
+        }
+        return value;
+    }
+
+    template <typename Container>
+    void getAll(Container& values) {
+        for (auto& value : values) {
+            value = static_cast<std::remove_reference_t<decltype(value)>>(get(sizeof(value)));
+        }
+    }
+
+private:
+    std::vector<uint8_t> const& blob_;
+    size_t offset_ = 0;
+};
+
+} // namespace
+
+std::vector<uint8_t> saveSnapshot(MachineState const& state) {
+    std::vector<uint8_t> blob;
+    blob.reserve(sizeof(MachineState));
+    blob.insert(end(blob), std::begin(SNAPSHOT_MAGIC), std::end(SNAPSHOT_MAGIC));
+    BlobWriter writer{ blob };
+    writer.put(SNAPSHOT_VERSION, 4);
+    writer.putAll(state.v);
+    writer.put(state.pc, 2);
+    writer.put(state.regI, 2);
+    writer.put(state.delayTimer, 1);
+    writer.put(state.soundTimer, 1);
+    writer.put(state.sp, 1);
+    writer.put(state.keyRegister, 1);
+    writer.put(state.waitingForKey, 1);
+    writer.putAll(state.random.words);
+    writer.putAll(state.stack);
+    writer.putAll(state.display);
+    writer.putAll(state.memory);
+    return blob;
+}
+
+MachineState loadSnapshot(std::vector<uint8_t> const& blob) {
+    if (blob.size() < sizeof(SNAPSHOT_MAGIC) || std::memcmp(blob.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        throw std::runtime_error("not a CHIP8 snapshot");
+    }
+    BlobReader reader{ blob };
+    reader.get(sizeof(SNAPSHOT_MAGIC));
+    auto version = reader.get(4);
+    if (version < FIRST_SNAPSHOT_VERSION || version > SNAPSHOT_VERSION) {
+        throw std::runtime_error("unsupported snapshot version " + std::to_string(version));
+    }
+
+    MachineState state;
+    reader.getAll(state.v);
+    state.pc = static_cast<uint16_t>(reader.get(2));
+    state.regI = static_cast<uint16_t>(reader.get(2));
+    state.delayTimer = static_cast<uint8_t>(reader.get(1));
+    state.soundTimer = static_cast<uint8_t>(reader.get(1));
+    state.sp = static_cast<uint8_t>(reader.get(1));
+    state.keyRegister = static_cast<uint8_t>(reader.get(1));
+    state.waitingForKey = reader.get(1) != 0;
+    // Version 1 predates the per-machine generator; keep the default seed.
+    if (version >= 2) {
+        reader.getAll(state.random.words);
+    }
+    reader.getAll(state.stack);
+    reader.getAll(state.display);
+    reader.getAll(state.memory);
+    if (state.sp > STACK_DEPTH || state.keyRegister >= REGISTER_COUNT || state.pc >= MEM_SIZE - 1) {
+        throw std::runtime_error("corrupt snapshot");
+    }
+    // 00EE jumps to any of them.
+    for (size_t i = 0; i < state.sp; ++i) {
+        if (state.stack[i] >= MEM_SIZE - 1) {
+            throw std::runtime_error("corrupt snapshot");
+        }
+    }
+    return state;
+}
+
+void writeSnapshot(std::ostream& os, MachineState const& state) {
+    auto blob = saveSnapshot(state);
+    os.write(reinterpret_cast<char const*>(blob.data()), blob.size());
+}
+
+MachineState readSnapshot(std::istream& is) {
+    std::vector<uint8_t> blob{ std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>() };
+    return loadSnapshot(blob);
+}
+
+} // namespace fakers
@@ -0,0 +1,125 @@
+#include "SpriteBlit.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace fakers
+{
+namespace
+{
+// Shift or rotate right by x; wrapShift 64 drops the pixels pushed past the
+// right edge.
+inline uint64_t place(uint64_t line, unsigned x, unsigned wrapShift) {
+    return (line >> x) | (wrapShift < 64 ? line << wrapShift : 0);
+}
+
+// Blits lines into consecutive rows, one 64-bit row per line; collisions
+// are ORed together and tested once at the end. Bit i of dirtyRows is
+// rows[i].
+BlitResult blitRun(uint64_t* rows, uint64_t const* lines, size_t count, unsigned x, unsigned wrapShift) {
+    uint64_t hits = 0;
+    uint32_t dirty = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t placed = place(lines[i], x, wrapShift);
+        hits |= rows[i] & placed;
+        rows[i] ^= placed;
+        dirty |= static_cast<uint32_t>(placed != 0) << i;
+    }
+    return { hits != 0, dirty };
+}
+
+} // namespace
+
+BlitResult blitSprite(uint64_t* rows, uint64_t const* lines, size_t count, unsigned x, unsigned y,
+    SpriteEdge edge) {
+    count = std::min(count, MAX_SPRITE_LINES);
+    bool wrap = edge == SpriteEdge::Wrap;
+    // Left shift that brings back the pixels pushed past the right edge;
+    // 64 drops them.
+    unsigned wrapShift = wrap && x ? 64 - x : 64;
+    size_t below = std::min<size_t>(count, DISPLAY_ROWS - y);
+    auto result = blitRun(rows + y, lines, below, x, wrapShift);
+    result.dirtyRows <<= y;
+    if (wrap && below < count) {
+        auto top = blitRun(rows, lines + below, count - below, x, wrapShift);
+        result.collision |= top.collision;
+        result.dirtyRows |= top.dirtyRows;
+    }
+    return result;
+}
+
+BlitResult blitSprite(HiResFramebuffer& rows, uint64_t const* lines, size_t count, unsigned x, unsigned y,
+    SpriteEdge edge) {
+    constexpr size_t HEIGHT = std::tuple_size_v<HiResFramebuffer>;
+    bool wrap = edge == SpriteEdge::Wrap;
+    BlitResult result{ false, 0 };
+    for (size_t i = 0; i < std::min(count, MAX_SPRITE_LINES * 2); ++i) {
+        size_t row = y + i;
+        if (row >= HEIGHT) {
+            if (!wrap) {
+                break;
+            }
+            row -= HEIGHT;
+        }
+        // Columns 0-63 in left, 64-127 in right; lines are at most 32
+        // pixels wide, so only x >= 64 can push pixels past column 127.
+        uint64_t line = lines[i];
+        uint64_t left = 0;
+        uint64_t right = 0;
+        if (x < 64) {
+            left = line >> x;
+            right = x ? line << (64 - x) : 0;
+        } else {
+            right = line >> (x - 64);
+            if (wrap && x > 64) {
+                left = line << (128 - x);
+            }
+        }
+        auto& bits = rows[row];
+        result.collision |= ((bits[0] & left) | (bits[1] & right)) != 0;
+        bits[0] ^= left;
+        bits[1] ^= right;
+        result.dirtyRows |= static_cast<uint64_t>((left | right) != 0) << row;
+    }
+    return result;
+}
+
+uint64_t doublePixels(uint64_t line) {
+    // Spread the top 32 bits over the whole word, then copy each bit into
+    // its right neighbour.
+    uint64_t bits = line >> 32;
+    bits = (bits | bits << 16) & 0x0000ffff0000ffffull;
+    bits = (bits | bits << 8) & 0x00ff00ff00ff00ffull;
+    bits = (bits | bits << 4) & 0x0f0f0f0f0f0f0f0full;
+    bits = (bits | bits << 2) & 0x3333333333333333ull;
+    bits = (bits | bits << 1) & 0x5555555555555555ull;
+    return bits | bits << 1;
+}
+
+void scrollDown(HiResFramebuffer& rows, size_t count) {
+    count = std::min(count, rows.size());
+    std::move_backward(begin(rows), end(rows) - count, end(rows));
+    std::fill(begin(rows), begin(rows) + count, HiResRow{});
+}
+
+void scrollUp(HiResFramebuffer& rows, size_t count) {
+    count = std::min(count, rows.size());
+    std::move(begin(rows) + count, end(rows), begin(rows));
+    std::fill(end(rows) - count, end(rows), HiResRow{});
+}
+
+void scrollRight(HiResFramebuffer& rows, unsigned count) {
+    for (auto& bits : rows) {
+        bits[1] = bits[1] >> count | bits[0] << (64 - count);
+        bits[0] >>= count;
+    }
+}
+
+void scrollLeft(HiResFramebuffer& rows, unsigned count) {
+    for (auto& bits : rows) {
+        bits[0] = bits[0] << count | bits[1] >> (64 - count);
+        bits[1] <<= count;
+    }
+}
+
+} // namespace fakers
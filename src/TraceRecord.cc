@@ -0,0 +1,154 @@
+#include "TraceRecord.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace fakers
+{
+namespace
+{
+void formatSkip(std::ostream& os, TraceRecord const& record, int nextPc) {
+    if (nextPc == record.pc + 4) {
+        os << " skip pc=" << record.pc + 2;
+    }
+}
+
+void formatAlu(std::ostream& os, int x, int y, int type) {
+    switch (type) {
+    case 0x0: os << "=V" << y; break;
+    case 0x1: os << "|=V" << y; break;
+    case 0x2: os << "&=V" << y << "V" << x; break;
+    case 0x3: os << "^=V" << y; break;
+    case 0x4: os << "+=V" << y; break;
+    case 0x5: os << "-=V" << y; break;
+    case 0x6: os << ">>=1"; break;
+    case 0x7: os << "=V" << y << "-V" << x; break;
+    case 0xe: os << "<<=1"; break;
+    default: os << "NOT HANDLED"; break;
+    }
+}
+
+void formatMisc(std::ostream& os, TraceRecord const& record, int x) {
+    switch (record.opcode & 0xff) {
+    case 0x07: os << "time V" << x << "=" << (int)record.value; break;
+    case 0x0a: os << "key  V" << x; break;
+    case 0x15: os << "time t=" << x; break;
+    case 0x18: os << "snd  s=" << x; break;
+    // The interpreter printed I as it was before the addition.
+    case 0x1e: os << "inc  I+=V" << x << "\t =>" << ((record.regI - record.value) & 0xffff); break;
+    case 0x29: os << "reg  I=0x" << record.regI << "(font)"; break;
+    case 0x33:
+        os << "bcd  load 0x" << (int)record.value
+            << " (" << record.value / 100 << ";" << record.value / 10 % 10 << ";" << record.value % 10 << ")";
+        break;
+    case 0x55: os << "reg  dump V[0;" << x << "]"; break;
+    case 0x65: os << "reg  load V[0;" << x << "]"; break;
+    }
+}
+
+} // namespace
+
+std::string formatTraceRecord(TraceRecord const& record, int nextPc) {
+    int opcode = record.opcode;
+    int x = (opcode >> 8) & 0xf;
+    int y = (opcode >> 4) & 0xf;
+    int n = opcode & 0xf;
+    int kk = opcode & 0xff;
+    int nnn = opcode & 0xfff;
+    int value = record.value;
+
+    std::ostringstream os;
+    os << "0x" << std::hex << record.pc << "\t0x" << opcode << ":\t";
+    switch (opcode >> 12) {
+    case 0x0:
+        if (opcode == 0x00E0) {
+            os << "cls";
+        } else if (opcode == 0x00EE) {
+            os << "ret";
+            if (nextPc >= 0) os << "  pc=0x" << nextPc;
+        } else {
+            os << "exec pc=0x" << nnn;
+        }
+        break;
+    case 0x1:
+        if (nnn == record.pc) {
+            os << "stop";
+        } else {
+            os << "goto pc=0x" << nnn;
+        }
+        break;
+    case 0x2:
+        os << "call pc=0x" << nnn;
+        break;
+    case 0x3:
+        os << "cmp  V" << x << " 0x" << value << "==0x" << kk;
+        formatSkip(os, record, nextPc);
+        break;
+    case 0x4:
+        os << "cmp  V" << x << " 0x" << value << "!=0x" << kk;
+        formatSkip(os, record, nextPc);
+        break;
+    case 0x5:
+        os << "cmp  V" << x << "==V" << y << " 0x" << value << " == 0x" << kk;
+        formatSkip(os, record, nextPc);
+        break;
+    case 0x6:
+        os << "asgn V" << x << "=0x" << kk << "\t =>" << value;
+        break;
+    case 0x7:
+        os << "inc  V" << x << "+=0x" << kk << "\t =>" << value;
+        break;
+    case 0x8:
+        os << "asgn V" << x;
+        formatAlu(os, x, y, n);
+        os << "\t =>" << value;
+        break;
+    case 0x9:
+        os << "cmp  V" << x << "!=V" << y;
+        formatSkip(os, record, nextPc);
+        break;
+    case 0xa:
+        os << "reg  I=0x" << nnn;
+        break;
+    case 0xb:
+        os << "goto pc=V0+0x" << nnn;
+        break;
+    case 0xc:
+        os << "rnd  V" << x << "= rand() & 0x" << kk;
+        break;
+    case 0xd:
+        os << "draw I=0x" << record.regI << std::dec << ":(" << (int)record.reg << ";" << value << ";" << n << ")";
+        break;
+    case 0xe:
+        os << "key" << value;
+        if (kk == 0x9E) os << " ON ";
+        if (kk == 0xA1) os << " OFF";
+        formatSkip(os, record, nextPc);
+        break;
+    case 0xf:
+        formatMisc(os, record, x);
+        break;
+    }
+    return os.str();
+}
+
+std::vector<TraceRecord> readTrace(std::istream& is) {
+    TraceFileHeader header{};
+    is.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!is || std::memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+        throw std::runtime_error("not a CHIP8 trace file");
+    }
+    if (header.version != TRACE_VERSION) {
+        throw std::runtime_error("unsupported trace version " + std::to_string(header.version));
+    }
+
+    std::vector<TraceRecord> records;
+    TraceRecord record;
+    while (is.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        records.push_back(record);
+    }
+    return records;
+}
+
+} // namespace fakers
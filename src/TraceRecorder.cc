@@ -0,0 +1,62 @@
+#include "TraceRecorder.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace fakers
+{
+namespace
+{
+constexpr size_t WRITE_BATCH = 4096;
+} // namespace
+
+TraceRecorder::TraceRecorder(std::string const& path, size_t capacity)
+    : ring_(capacity), out_(path, std::ios::binary), start_(std::chrono::steady_clock::now()) {
+    if (!out_) {
+        throw std::runtime_error("cannot open trace file " + path);
+    }
+    TraceFileHeader header{ { TRACE_MAGIC[0], TRACE_MAGIC[1], TRACE_MAGIC[2], TRACE_MAGIC[3] }, TRACE_VERSION };
+    out_.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    writer_ = std::thread{ &TraceRecorder::drain, this };
+}
+
+TraceRecorder::~TraceRecorder() {
+    stopping_ = true;
+    writer_.join();
+}
+
+void TraceRecorder::record(TraceRecord const& record) {
+    TraceRecord stamped = record;
+    stamped.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_).count();
+    while (!ring_.push(stamped)) {
+        // Writer is behind; never drop records, give it the core instead.
+        std::this_thread::yield();
+    }
+    ++recorded_;
+}
+
+void TraceRecorder::drain() {
+    using namespace std::chrono_literals;
+    std::vector<TraceRecord> batch;
+    batch.reserve(WRITE_BATCH);
+    while (true) {
+        bool stopping = stopping_;
+        TraceRecord record;
+        while (batch.size() < WRITE_BATCH && ring_.pop(record)) {
+            batch.push_back(record);
+        }
+        if (!batch.empty()) {
+            out_.write(reinterpret_cast<char const*>(batch.data()), batch.size() * sizeof(TraceRecord));
+            batch.clear();
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    out_.flush();
+}
+
+} // namespace fakers
@@ -0,0 +1,567 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "FakeChip8HeadlessRunner.h"
+#include "KeyEventQueue.h"
+#include "LockstepChip8.h"
+#include "RewindRing.h"
+#include "RomReader.h"
+#include "Snapshot.h"
+#include "SpriteBlit.h"
+#include "TraceRecorder.h"
+
+namespace
+{
+// Every heap allocation made by the process, for --allocs.
+std::atomic<uint64_t> allocations{ 0 };
+} // namespace
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace
+{
+// Each synthetic ROM loops forever over one family of opcodes.
+const std::vector<std::pair<std::string, std::vector<uint8_t>>> SYNTHETIC_ROMS = {
+    { "synthetic/alu", {
+        0x60, 0x12, // V0=0x12
+        0x61, 0x34, // V1=0x34
+        0x70, 0x01, // V0+=1
+        0x80, 0x14, // V0+=V1
+        0x82, 0x00, // V2=V0
+        0x82, 0x11, // V2|=V1
+        0x82, 0x12, // V2&=V1
+        0x82, 0x13, // V2^=V1
+        0x83, 0x05, // V3-=V0
+        0x83, 0x06, // V3>>=1
+        0x84, 0x37, // V4=V3-V4
+        0x84, 0x0E, // V4<<=1
+        0x71, 0x03, // V1+=3
+        0x12, 0x04, // goto 0x204
+    } },
+    { "synthetic/branch", {
+        0x60, 0x00, // V0=0
+        0x70, 0x01, // V0+=1
+        0x30, 0x80, // skip V0==0x80
+        0x22, 0x10, // call 0x210
+        0x40, 0x80, // skip V0!=0x80
+        0x60, 0x00, // V0=0
+        0x12, 0x02, // goto 0x202
+        0x00, 0x00,
+        0x51, 0x00, // skip V1==V0
+        0x71, 0x01, // V1+=1
+        0x91, 0x00, // skip V1!=V0
+        0x61, 0x00, // V1=0
+        0x00, 0xEE, // ret
+    } },
+    { "synthetic/memory", {
+        0xA3, 0x00, // I=0x300
+        0x70, 0x07, // V0+=7
+        0xF0, 0x33, // bcd V0
+        0xF0, 0x1E, // I+=V0
+        0xFF, 0x55, // dump V[0;F]
+        0xA3, 0x00, // I=0x300
+        0xF5, 0x65, // load V[0;5]
+        0xF1, 0x29, // I=font(V1)
+        0x12, 0x00, // goto 0x200
+    } },
+    { "synthetic/draw", {
+        0x00, 0xE0, // cls
+        0x60, 0x00, // V0=0
+        0x61, 0x00, // V1=0
+        0x62, 0x00, // V2=0
+        0xF2, 0x29, // I=font(V2)
+        0xD0, 0x15, // draw V0,V1,5
+        0x70, 0x05, // V0+=5
+        0x72, 0x01, // V2+=1
+        0x32, 0x10, // skip V2==0x10
+        0x12, 0x08, // goto 0x208
+        0x71, 0x06, // V1+=6
+        0x62, 0x00, // V2=0
+        0x31, 0x1E, // skip V1==0x1e
+        0x12, 0x08, // goto 0x208
+        0x12, 0x00, // goto 0x200
+    } },
+    { "synthetic/selfmod", {
+        0x60, 0x63, // V0=0x63
+        0x61, 0x00, // V1=0
+        0xA2, 0x0A, // I=0x20a
+        0xF1, 0x55, // dump V[0;1], rewrites 0x20a to 63xx
+        0x12, 0x0A, // goto 0x20a
+        0x00, 0xE0, // V3=V1 once patched
+        0x71, 0x01, // V1+=1
+        0x12, 0x04, // goto 0x204
+    } },
+};
+
+constexpr uint64_t DEFAULT_INSTRUCTIONS = 2'000'000;
+
+constexpr uint64_t DIFF_CHECKPOINT = 1000;
+constexpr unsigned DIFF_SEED = 0xc8;
+
+// Addresses and instructions listed by --profile.
+constexpr size_t PROFILE_HOTTEST = 3;
+
+fakers::HeadlessReport runSilenced(std::vector<uint8_t> const& program, uint64_t maxInstructions,
+    std::string const& tracePath, fakers::HeadlessConfig const& config,
+    fakers::Machine machine = fakers::Machine::Chip8, fakers::QuirkProfile quirks = fakers::QuirkProfile::Default,
+    fakers::ProfileCounters* profile = nullptr) {
+    fakers::FakeChip8HeadlessRunner runner{ config };
+    fakers::HeadlessReport report;
+    if (profile) {
+        report = fakers::withCore<fakers::Profiling>(machine, quirks, [&](auto core) {
+            return runner.run<typename decltype(core)::type>(program, maxInstructions, nullptr, profile);
+        });
+    } else if (tracePath.empty()) {
+        report = fakers::withCore<fakers::NoTrace>(machine, quirks, [&](auto core) {
+            return runner.run<typename decltype(core)::type>(program, maxInstructions);
+        });
+    } else {
+        fakers::TraceRecorder recorder{ tracePath };
+        report = fakers::withCore<fakers::BinaryTrace>(machine, quirks, [&](auto core) {
+            return runner.run<typename decltype(core)::type>(program, maxInstructions, &recorder);
+        });
+    }
+    return report;
+}
+
+// `config` for the ROM at `romPath`: with a --movies directory, the ROM's
+// recorded input `<name>.keys` there is replayed, so a game past its title
+// screen is measured instead of the cycles it idles waiting for a key.
+fakers::HeadlessConfig romConfig(fakers::HeadlessConfig config, std::string_view romPath, std::string const& moviesPath) {
+    if (moviesPath.empty()) {
+        return config;
+    }
+    auto movie = std::filesystem::path{ moviesPath } / std::filesystem::path{ romPath }.filename();
+    if (std::ifstream keys{ movie.string() + ".keys" }) {
+        config.input = fakers::keyScript(fakers::readKeyLog(keys));
+    }
+    return config;
+}
+
+// A replayed movie ends the run at its last key change; past it the game
+// only waits for input again.
+uint64_t runLength(fakers::HeadlessConfig const& config, uint64_t maxInstructions) {
+    return config.input.empty() ? maxInstructions : std::min(maxInstructions, config.input.back().cycle);
+}
+
+// Runs the plain and the profiled core over the same instructions and
+// reports the profiling overhead and the hottest addresses and instructions.
+bool benchProfile(std::string_view name, std::vector<uint8_t> const& program, uint64_t maxInstructions,
+    fakers::HeadlessConfig const& config, fakers::Machine machine, fakers::QuirkProfile quirks) {
+    auto plain = runSilenced(program, maxInstructions, {}, config, machine, quirks);
+    auto counters = std::make_unique<fakers::ProfileCounters>();
+    auto const& profile = *counters;
+    auto profiled = runSilenced(program, maxInstructions, {}, config, machine, quirks, counters.get());
+    auto instructions = profile.instructions();
+    auto ops = profile.ops();
+
+    auto hottest = [](auto const& counts) {
+        std::vector<size_t> order(counts.size());
+        std::iota(begin(order), end(order), 0);
+        size_t count = std::min(PROFILE_HOTTEST, order.size());
+        std::partial_sort(begin(order), begin(order) + count, end(order),
+            [&](size_t a, size_t b) { return counts[a] > counts[b]; });
+        order.resize(count);
+        return order;
+    };
+    auto share = [&](uint64_t count) { return 100.0 * count / std::max<uint64_t>(instructions, 1); };
+    std::cout << std::fixed << std::setprecision(2) << name << ": plain=" << plain.nsPerInstruction()
+        << "ns/instr profiled=" << profiled.nsPerInstruction() << "ns/instr overhead="
+        << 100.0 * (profiled.nsPerInstruction() / std::max(plain.nsPerInstruction(), 1e-9) - 1) << "%"
+        << " draws=" << profile.draws << " collisions=" << profile.collisions
+        << " keyWait=" << profile.keyWaitCycles << " hot=";
+    for (size_t address : hottest(profile.addresses)) {
+        std::cout << std::hex << "0x" << address << std::dec << "(" << share(profile.addresses[address]) << "%) ";
+    }
+    std::cout << "ops=";
+    for (size_t op : hottest(ops)) {
+        std::cout << fakers::opInfo(static_cast<fakers::Op>(op)).name << "(" << share(ops[op]) << "%) ";
+    }
+    bool ok = plain.finalHash == profiled.finalHash && instructions == profiled.instructions
+        && profile.keyWaitCycles == profiled.idleCycles;
+    std::cout << (ok ? "\n" : "MISMATCH\n");
+    return ok;
+}
+
+// Runs the interpreter and the block engine from the same seed and compares
+// the state hashes at every checkpoint.
+bool diffEngines(std::string_view name, std::vector<uint8_t> const& program, uint64_t maxInstructions,
+    fakers::Machine machine, fakers::QuirkProfile quirks) {
+    fakers::HeadlessConfig config;
+    config.checkpointInterval = DIFF_CHECKPOINT;
+    config.engine = fakers::Engine::Interpreter;
+    config.seed = DIFF_SEED;
+    auto reference = runSilenced(program, maxInstructions, {}, config, machine, quirks);
+    config.engine = fakers::Engine::CachedBlocks;
+    auto blocks = runSilenced(program, maxInstructions, {}, config, machine, quirks);
+
+    auto const& expected = reference.checkpoints;
+    auto const& actual = blocks.checkpoints;
+    auto mismatch = std::mismatch(begin(expected), end(expected), begin(actual), end(actual),
+        [](fakers::Checkpoint const& a, fakers::Checkpoint const& b) { return a.state == b.state; });
+    if (mismatch.first != end(expected) || mismatch.second != end(actual)) {
+        auto checkpoint = std::distance(begin(expected), mismatch.first);
+        std::cout << name << ": MISMATCH after " << (checkpoint + 1) * DIFF_CHECKPOINT << " cycles\n";
+        return false;
+    }
+    std::cout << name << ": ok, " << expected.size() << " checkpoints\n";
+    return true;
+}
+
+struct HeldKeys : fakers::InputIO {
+    std::bitset<16> keys;
+    std::bitset<16> read() override { return keys; }
+};
+
+// Lane l of the lockstep run holds the keys of the bits of l, so lanes
+// diverge as soon as the program reads the keypad.
+std::bitset<16> laneKeys(size_t lane) {
+    return std::bitset<16>(lane & 0xffff);
+}
+
+// Runs `lanes` separate FakeChip8 instances and one LockstepChip8 with the
+// same number of lanes for maxInstructions cycles each, then compares the
+// per-lane state hashes.
+bool benchLockstep(std::string_view name, std::vector<uint8_t> const& program, uint64_t maxInstructions,
+    size_t lanes) {
+    using Clock = std::chrono::steady_clock;
+    fakers::SchedulerConfig config{ fakers::SchedulerConfig{}.cyclesPerSecond, true };
+
+    std::vector<fakers::FakeChip8> scalar(lanes);
+    std::vector<HeldKeys> inputs(lanes);
+    fakers::NullDisplay display;
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        inputs[lane].keys = laneKeys(lane);
+        scalar[lane].attachDisplay(&display);
+        scalar[lane].attachIO(&inputs[lane]);
+        scalar[lane].seed(DIFF_SEED + lane);
+        scalar[lane].load(program);
+    }
+
+    auto start = Clock::now();
+    for (auto& chip8 : scalar) {
+        fakers::ClockScheduler scheduler{ config };
+        scheduler.runCycles(chip8, maxInstructions);
+    }
+    std::chrono::duration<double> scalarTime = Clock::now() - start;
+
+    fakers::LockstepChip8 lockstep{ lanes };
+    lockstep.load(program);
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        lockstep.setKeys(lane, laneKeys(lane));
+        lockstep.seed(lane, DIFF_SEED + lane);
+    }
+    start = Clock::now();
+    fakers::ClockScheduler scheduler{ config };
+    scheduler.runCycles(lockstep, maxInstructions);
+    std::chrono::duration<double> lockstepTime = Clock::now() - start;
+
+    size_t matching = 0;
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        matching += fakers::hashState(scalar[lane]) == fakers::hashState(lockstep.lane(lane));
+    }
+    double executed = lockstep.vectorInstructions() + lockstep.scalarInstructions();
+    double cycles = static_cast<double>(maxInstructions) * lanes;
+    std::cout << std::fixed << std::setprecision(2) << name << ": lanes=" << lanes
+        << " scalar=" << scalarTime.count() * 1e3 << "ms (" << cycles / scalarTime.count() << " cycles/s)"
+        << " lockstep=" << lockstepTime.count() * 1e3 << "ms (" << cycles / lockstepTime.count() << " cycles/s)"
+        << " speedup=" << scalarTime.count() / lockstepTime.count()
+        << " vectorized=" << (executed ? 100.0 * lockstep.vectorInstructions() / executed : 0.0) << "%"
+        << " matching=" << matching << "/" << lanes << '\n';
+    return matching == lanes;
+}
+
+// Counts the heap allocations made while a loaded machine runs. Neither
+// engine may allocate: the block cache is sized when the ROM loads.
+bool countAllocations(std::string_view name, std::vector<uint8_t> const& program, uint64_t maxInstructions) {
+    bool ok = true;
+    std::cout << name << ":";
+    for (auto engine : { fakers::Engine::Interpreter, fakers::Engine::CachedBlocks }) {
+        fakers::NullDisplay display;
+        fakers::NullInput input;
+        fakers::FakeChip8 chip8{ engine };
+        chip8.attachDisplay(&display);
+        chip8.attachIO(&input);
+        chip8.load(program);
+
+        fakers::ClockScheduler scheduler{ fakers::SchedulerConfig{ fakers::SchedulerConfig{}.cyclesPerSecond, true } };
+        uint64_t before = allocations;
+        scheduler.runCycles(chip8, maxInstructions);
+        uint64_t count = allocations - before;
+        std::cout << (engine == fakers::Engine::Interpreter ? " interpreter=" : " blocks=") << count;
+        ok &= count == 0;
+    }
+    std::cout << (ok ? "\n" : " FAIL\n");
+    return ok;
+}
+
+// Runs frame by frame, capturing every frame into a RewindRing. Reports
+// the capture cost and the ring's footprint, then checks that every ring
+// entry and a snapshot blob round trip restore the exact state.
+bool benchRewind(std::string_view name, std::vector<uint8_t> const& program, uint64_t maxInstructions) {
+    fakers::NullDisplay display;
+    fakers::NullInput input;
+    fakers::FakeChip8 chip8;
+    chip8.attachDisplay(&display);
+    chip8.attachIO(&input);
+    chip8.load(program);
+
+    fakers::ClockScheduler scheduler{ fakers::SchedulerConfig{ fakers::SchedulerConfig{}.cyclesPerSecond, true } };
+    fakers::RewindRing ring{ fakers::RewindConfig{ 1, SIZE_MAX } };
+    std::vector<uint64_t> frameHashes;
+    std::chrono::nanoseconds captureTime{};
+    while (scheduler.cycles() < maxInstructions && scheduler.runFrame(chip8)) {
+        auto start = std::chrono::steady_clock::now();
+        ring.capture(scheduler.frames(), chip8.state());
+        captureTime += std::chrono::steady_clock::now() - start;
+        frameHashes.push_back(fakers::hashState(chip8));
+    }
+
+    bool ok = true;
+    fakers::FakeChip8 restored;
+    for (size_t stepsBack = 0; stepsBack < ring.size(); ++stepsBack) {
+        restored.restore(ring.restore(stepsBack));
+        ok &= fakers::hashState(restored) == frameHashes[ring.frame(stepsBack) - 1];
+    }
+    auto blob = fakers::saveSnapshot(chip8.state());
+    ok &= fakers::saveSnapshot(fakers::loadSnapshot(blob)) == blob;
+
+    double snapshots = static_cast<double>(std::max<size_t>(ring.size(), 1));
+    std::cout << std::fixed << std::setprecision(2) << name << ": frames=" << scheduler.frames()
+        << " snapshots=" << ring.size()
+        << " ring=" << ring.memoryBytes() / 1024.0 << "KiB (" << ring.memoryBytes() / snapshots << " B/snapshot)"
+        << " capture=" << captureTime.count() / snapshots << "ns"
+        << " blob=" << blob.size() << "B"
+        << (ok ? " restore ok" : " RESTORE MISMATCH") << '\n';
+    return ok;
+}
+
+// Line by line reference for blitSprite, as Dxyn used to draw.
+fakers::BlitResult referenceBlit(uint64_t* rows, uint64_t const* lines, size_t count, unsigned x, unsigned y,
+    fakers::SpriteEdge edge) {
+    bool wrap = edge == fakers::SpriteEdge::Wrap;
+    fakers::BlitResult result{ false, 0 };
+    for (size_t i = 0; i < count; ++i) {
+        size_t row = y + i;
+        if (row >= fakers::DISPLAY_ROWS) {
+            if (!wrap) {
+                break;
+            }
+            row -= fakers::DISPLAY_ROWS;
+        }
+        uint64_t line = lines[i] >> x;
+        if (wrap && x) {
+            line |= lines[i] << (64 - x);
+        }
+        result.collision |= (rows[row] & line) != 0;
+        rows[row] ^= line;
+        result.dirtyRows |= static_cast<uint32_t>(line != 0) << row;
+    }
+    return result;
+}
+
+// Draws the same random sprites with blitSprite and the reference, checks
+// that displays, collisions and dirty rows agree, and times both.
+bool benchBlit(uint64_t blits) {
+    using Clock = std::chrono::steady_clock;
+    constexpr size_t SPRITES = 256;
+    struct Sprite {
+        uint64_t lines[fakers::MAX_SPRITE_LINES];
+        size_t count;
+        unsigned x;
+        unsigned y;
+    };
+    bool ok = true;
+    for (bool wide : { false, true }) {
+        for (auto edge : { fakers::SpriteEdge::Clip, fakers::SpriteEdge::Wrap }) {
+            std::mt19937_64 random{ DIFF_SEED };
+            std::vector<uint8_t> memory(2 * fakers::MAX_SPRITE_LINES);
+            std::vector<Sprite> sprites(SPRITES);
+            for (auto& sprite : sprites) {
+                for (auto& byte : memory) {
+                    byte = static_cast<uint8_t>(random());
+                }
+                sprite.count = wide
+                    ? fakers::loadWideSprite(memory.data(), memory.size(), 0, sprite.lines)
+                    : fakers::loadSprite(memory.data(), memory.size(), 0, 1 + random() % 15, sprite.lines);
+                sprite.x = random() % 64;
+                sprite.y = random() % fakers::DISPLAY_ROWS;
+            }
+
+            auto time = [&](auto blit, fakers::Framebuffer& display, uint64_t& check) {
+                auto start = Clock::now();
+                for (uint64_t i = 0; i < blits; ++i) {
+                    auto const& sprite = sprites[i % SPRITES];
+                    auto result = blit(display.data(), sprite.lines, sprite.count, sprite.x, sprite.y, edge);
+                    check = check * 31 + result.collision + result.dirtyRows;
+                }
+                return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / std::max<uint64_t>(blits, 1);
+            };
+            fakers::Framebuffer reference{};
+            fakers::Framebuffer blitted{};
+            uint64_t referenceCheck = 0;
+            uint64_t blitCheck = 0;
+            double referenceNs = time(referenceBlit, reference, referenceCheck);
+            auto blitSprite = [](uint64_t* rows, uint64_t const* lines, size_t count, unsigned x, unsigned y,
+                fakers::SpriteEdge edge) { return fakers::blitSprite(rows, lines, count, x, y, edge); };
+            double blitNs = time(blitSprite, blitted, blitCheck);
+            bool match = reference == blitted && referenceCheck == blitCheck;
+            ok &= match;
+            std::cout << std::fixed << std::setprecision(2) << (wide ? "blit/16x16" : "blit/8xn")
+                << (edge == fakers::SpriteEdge::Wrap ? "/wrap" : "/clip") << ": blits=" << blits
+                << " reference=" << referenceNs << "ns blit=" << blitNs << "ns"
+                << " speedup=" << referenceNs / blitNs << (match ? " ok" : " MISMATCH") << '\n';
+        }
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t maxInstructions = DEFAULT_INSTRUCTIONS;
+    std::string tracePath;
+    std::string moviesPath;
+    fakers::HeadlessConfig config;
+    bool diff = false;
+    size_t lockstepLanes = 0;
+    bool allocs = false;
+    bool rewind = false;
+    bool blit = false;
+    bool profile = false;
+    fakers::Machine machine = fakers::Machine::Chip8;
+    fakers::QuirkProfile quirks = fakers::QuirkProfile::Default;
+    std::vector<std::string_view> romPaths;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            maxInstructions = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--movies" && i + 1 < argc) {
+            moviesPath = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--blocks") {
+            config.engine = fakers::Engine::CachedBlocks;
+        } else if (arg == "--diff") {
+            diff = true;
+        } else if (arg == "--lockstep" && i + 1 < argc) {
+            lockstepLanes = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--allocs") {
+            allocs = true;
+        } else if (arg == "--rewind") {
+            rewind = true;
+        } else if (arg == "--blit") {
+            blit = true;
+        } else if (arg == "--profile") {
+            profile = true;
+        } else if (arg == "--machine" && i + 1 < argc) {
+            std::string_view name = argv[++i];
+            machine = name == "schip" ? fakers::Machine::SuperChip
+                : name == "xochip" ? fakers::Machine::XoChip : fakers::Machine::Chip8;
+        } else if (arg == "--quirks" && i + 1 < argc) {
+            quirks = fakers::quirkProfileNamed(argv[++i]).value_or(fakers::QuirkProfile::Default);
+        } else {
+            romPaths.push_back(arg);
+        }
+    }
+
+    if (diff) {
+        bool ok = true;
+        for (auto const& [name, program] : SYNTHETIC_ROMS) {
+            ok &= diffEngines(name, program, maxInstructions, machine, quirks);
+        }
+        for (auto romPath : romPaths) {
+            ok &= diffEngines(romPath, fakers::readRom(romPath), maxInstructions, machine, quirks);
+        }
+        return ok ? 0 : 1;
+    }
+
+    if (allocs) {
+        bool ok = true;
+        for (auto const& [name, program] : SYNTHETIC_ROMS) {
+            ok &= countAllocations(name, program, maxInstructions);
+        }
+        for (auto romPath : romPaths) {
+            ok &= countAllocations(romPath, fakers::readRom(romPath), maxInstructions);
+        }
+        return ok ? 0 : 1;
+    }
+
+    if (rewind) {
+        bool ok = true;
+        for (auto const& [name, program] : SYNTHETIC_ROMS) {
+            ok &= benchRewind(name, program, maxInstructions);
+        }
+        for (auto romPath : romPaths) {
+            ok &= benchRewind(romPath, fakers::readRom(romPath), maxInstructions);
+        }
+        return ok ? 0 : 1;
+    }
+
+    if (blit) {
+        return benchBlit(maxInstructions) ? 0 : 1;
+    }
+
+    if (profile) {
+        bool ok = true;
+        for (auto const& [name, program] : SYNTHETIC_ROMS) {
+            ok &= benchProfile(name, program, maxInstructions, config, machine, quirks);
+        }
+        for (auto romPath : romPaths) {
+            auto romRun = romConfig(config, romPath, moviesPath);
+            ok &= benchProfile(romPath, fakers::readRom(romPath), runLength(romRun, maxInstructions), romRun, machine,
+                quirks);
+        }
+        return ok ? 0 : 1;
+    }
+
+    if (lockstepLanes) {
+        bool ok = true;
+        for (auto const& [name, program] : SYNTHETIC_ROMS) {
+            ok &= benchLockstep(name, program, maxInstructions, lockstepLanes);
+        }
+        for (auto romPath : romPaths) {
+            ok &= benchLockstep(romPath, fakers::readRom(romPath), maxInstructions, lockstepLanes);
+        }
+        return ok ? 0 : 1;
+    }
+
+    for (auto const& [name, program] : SYNTHETIC_ROMS) {
+        std::cout << name << ": " << runSilenced(program, maxInstructions, tracePath, config, machine, quirks) << '\n';
+    }
+    for (auto romPath : romPaths) {
+        auto program = fakers::readRom(romPath);
+        auto romRun = romConfig(config, romPath, moviesPath);
+        std::cout << romPath << ": "
+                  << runSilenced(program, runLength(romRun, maxInstructions), tracePath, romRun, machine, quirks) << '\n';
+    }
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "Disassembler.h"
+#include "RomLibrary.h"
+
+namespace
+{
+char const* edgeName(fakers::EdgeKind kind) {
+    switch (kind) {
+    case fakers::EdgeKind::FallThrough: return "fall";
+    case fakers::EdgeKind::Skip: return "skip";
+    case fakers::EdgeKind::Jump: return "jump";
+    case fakers::EdgeKind::Call: return "call";
+    }
+    return "";
+}
+
+// Code with labels on block starts, data as rows of bytes.
+void printListing(fakers::Disassembly const& disassembly, uint8_t const* program) {
+    constexpr int BYTES_PER_ROW = 8;
+    std::cout << std::hex;
+    int address = disassembly.programStart;
+    while (address < disassembly.programEnd) {
+        if (auto it = disassembly.instructions.find(address); it != end(disassembly.instructions)) {
+            if (disassembly.callTargets.count(address)) {
+                std::cout << "\nsub_" << address << ":\n";
+            } else if (disassembly.blocks.count(address)) {
+                std::cout << "loc_" << address << ":\n";
+            }
+            std::cout << "0x" << address << "\t0x" << it->second.opcode << ":\t"
+                << fakers::formatInstruction(it->second) << '\n';
+            address += fakers::opInfo(it->second.op).length;
+            continue;
+        }
+        std::cout << "0x" << address << "\tdb  ";
+        int row = 0;
+        do {
+            std::cout << (row ? " 0x" : "0x") << static_cast<int>(program[address - disassembly.programStart]);
+            ++address;
+        } while (++row < BYTES_PER_ROW && address < disassembly.programEnd
+            && !disassembly.instructions.count(address));
+        std::cout << '\n';
+    }
+    std::cout << std::dec;
+}
+
+void printBlocks(fakers::Disassembly const& disassembly) {
+    std::cout << std::hex;
+    for (auto const& [start, block] : disassembly.blocks) {
+        std::cout << "0x" << block.start << "-0x" << block.end << (disassembly.callTargets.count(start) ? " sub" : "");
+        char const* separator = " ->";
+        for (auto const& edge : block.successors) {
+            std::cout << separator << " 0x" << edge.target << ' ' << edgeName(edge.kind);
+            separator = ",";
+        }
+        std::cout << '\n';
+    }
+    std::cout << std::dec;
+}
+
+void printDot(fakers::Disassembly const& disassembly) {
+    std::cout << "digraph cfg {\n    node [shape=box fontname=monospace];\n" << std::hex;
+    for (auto const& [start, block] : disassembly.blocks) {
+        std::cout << "    \"0x" << start << "\" [label=\"";
+        for (auto it = disassembly.instructions.find(start);
+            it != end(disassembly.instructions) && it->first < block.end; ++it) {
+            std::cout << "0x" << it->first << ": " << fakers::formatInstruction(it->second) << "\\l";
+        }
+        std::cout << "\"];\n";
+        for (auto const& edge : block.successors) {
+            std::cout << "    \"0x" << start << "\" -> \"0x" << edge.target << "\" [label=" << edgeName(edge.kind)
+                << "];\n";
+        }
+    }
+    std::cout << std::dec << "}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool extended = false;
+    bool xo = false;
+    bool blocks = false;
+    bool dot = false;
+    std::string romPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--machine" && i + 1 < argc) {
+            std::string_view name = argv[++i];
+            extended = name == "schip" || name == "xochip";
+            xo = name == "xochip";
+        } else if (arg == "--cfg") {
+            blocks = true;
+        } else if (arg == "--dot") {
+            dot = true;
+        } else {
+            romPath = arg;
+        }
+    }
+    if (romPath.empty()) {
+        std::cerr << "Wrong number of arguments\n";
+        std::cerr << "<program> [--machine <chip8|schip|xochip>] [--cfg | --dot] <romPath>";
+        return -1;
+    }
+    try {
+        fakers::MappedFile rom{ romPath };
+        auto disassembly = fakers::disassemble(rom.data(), rom.size(), extended, xo);
+        if (dot) {
+            printDot(disassembly);
+            return 0;
+        }
+        if (blocks) {
+            printBlocks(disassembly);
+        } else {
+            printListing(disassembly, rom.data());
+        }
+        int code = 0;
+        for (auto const& [address, instruction] : disassembly.instructions) {
+            code += fakers::opInfo(instruction.op).length;
+        }
+        std::cerr << "instructions=" << disassembly.instructions.size()
+            << " blocks=" << disassembly.blocks.size()
+            << " subroutines=" << disassembly.callTargets.size()
+            << " indirect=" << disassembly.indirectJumps.size()
+            << " invalid=" << disassembly.invalid.size()
+            << " code=" << code << "B data=" << static_cast<int>(rom.size()) - code << "B\n";
+    } catch (std::exception& e) {
+        std::cerr << "ERROR:" << e.what() << "\n";
+        return -1;
+    }
+}
@@ -0,0 +1,133 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "EmulatorFarm.h"
+#include "RomLibrary.h"
+#include "StateHash.h"
+
+namespace
+{
+constexpr uint64_t DEFAULT_CYCLES = 1'000'000;
+constexpr unsigned DEFAULT_INSTANCES = 64;
+constexpr uint64_t MEAN_KEY_INTERVAL = 2000;
+
+// A random walk over the keypad: one key held at a time, or none.
+std::vector<fakers::KeyEvent> randomInput(uint64_t seed, uint64_t cycles) {
+    std::mt19937_64 rng{ seed };
+    std::uniform_int_distribution<uint64_t> gap{ 1, 2 * MEAN_KEY_INTERVAL };
+    std::uniform_int_distribution<int> key{ -1, 15 };
+    std::vector<fakers::KeyEvent> events;
+    for (uint64_t cycle = gap(rng); cycle < cycles; cycle += gap(rng)) {
+        std::bitset<16> keys;
+        if (int k = key(rng); k >= 0) {
+            keys.set(k);
+        }
+        events.push_back({ cycle, keys });
+    }
+    return events;
+}
+
+uint64_t framebufferHash(fakers::Framebuffer const& framebuffer) {
+    fakers::StateHash hash;
+    hash.addAll(framebuffer);
+    return hash.value();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    fakers::FarmConfig config;
+    uint64_t cycles = DEFAULT_CYCLES;
+    unsigned instances = DEFAULT_INSTANCES;
+    uint64_t seed = 0;
+    bool printResults = false;
+    bool scaling = false;
+    std::vector<std::string_view> romPaths;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            config.threads = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "-n" && i + 1 < argc) {
+            cycles = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "-i" && i + 1 < argc) {
+            instances = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--blocks") {
+            config.engine = fakers::Engine::CachedBlocks;
+        } else if (arg == "--results") {
+            printResults = true;
+        } else if (arg == "--scaling") {
+            scaling = true;
+        } else {
+            romPaths.push_back(arg);
+        }
+    }
+    if (romPaths.empty()) {
+        std::cerr << "<program> [-j threads] [-n cycles] [-i instances] [--seed s] [--blocks] [--results] [--scaling] <roms, ROM directories or packs...>";
+        return -1;
+    }
+
+    fakers::RomLibrary library;
+    for (auto romPath : romPaths) {
+        library.add(std::string{ romPath });
+    }
+    for (auto const& rejected : library.rejected()) {
+        std::cerr << rejected.name << ": skipped, " << rejected.reason << '\n';
+    }
+
+    std::vector<fakers::FarmJob> jobs;
+    for (auto const& rom : library.entries()) {
+        for (unsigned instance = 0; instance < instances; ++instance) {
+            uint64_t jobSeed = seed ^ (jobs.size() * 0x9e3779b97f4a7c15ull);
+            jobs.push_back({ rom.name + "#" + std::to_string(instance), &rom,
+                randomInput(jobSeed, cycles), cycles, jobSeed });
+        }
+    }
+
+    std::vector<unsigned> threadCounts;
+    if (scaling) {
+        for (unsigned threads = 1; threads < config.threads; threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+    }
+    threadCounts.push_back(config.threads);
+
+    fakers::FarmReport report;
+    std::vector<std::pair<unsigned, fakers::FarmReport>> runs;
+    for (auto threads : threadCounts) {
+        auto runConfig = config;
+        runConfig.threads = threads;
+        report = fakers::EmulatorFarm{ runConfig }.run(jobs);
+        runs.emplace_back(threads, report);
+    }
+
+    if (printResults) {
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            auto const& result = report.results[i];
+            std::cout << jobs[i].name << std::hex
+                << " regs=" << result.registerHash
+                << " fb=" << framebufferHash(result.framebuffer) << std::dec
+                << " cycles=" << result.cycles
+                << " idle=" << result.idleCycles
+                << (result.halted ? " halted" : "")
+                << (result.error.empty() ? "" : " error=" + result.error) << '\n';
+        }
+    }
+    for (auto const& [threads, run] : runs) {
+        std::cout << std::fixed << std::setprecision(2)
+            << "threads=" << threads
+            << " jobs=" << jobs.size()
+            << " cycles=" << run.totalCycles()
+            << " instructions=" << run.totalInstructions()
+            << " wall=" << std::chrono::duration<double, std::milli>(run.wallTime).count() << "ms"
+            << " ips=" << run.instructionsPerSecond()
+            << " steals=" << run.steals << '\n';
+    }
+}
@@ -0,0 +1,711 @@
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Chip8Decode.h"
+#include "Disassembler.h"
+#include "FakeChip8.h"
+#include "LockstepChip8.h"
+#include "ReferenceChip8.h"
+#include "RomLibrary.h"
+
+namespace
+{
+using fakers::Op;
+
+constexpr uint64_t DEFAULT_FIRST_SEED = 1;
+constexpr uint64_t DEFAULT_ROMS = 1000;
+constexpr uint64_t DEFAULT_STEPS = 5000;
+// Instructions per 60 Hz tick, as far as the timers are concerned.
+constexpr uint64_t TIMER_PERIOD = 8;
+// One in KEY_CHANGE steps changes the held keys.
+constexpr int KEY_CHANGE = 32;
+constexpr size_t LOCKSTEP_LANES = 4;
+// Keeps the key schedule apart from the ROM drawn from the same seed.
+constexpr uint64_t KEY_STREAM = 0x6b657973;
+// Likewise for the slice lengths and keys of compareSlices().
+constexpr uint64_t SLICE_STREAM = 0x736c6963;
+
+// <random>'s distributions differ between standard libraries; a failing
+// seed has to reproduce everywhere.
+class Dice {
+public:
+    explicit Dice(uint64_t seed) : state_(fakers::seedRandom(seed)) {}
+
+    int below(int bound) { return static_cast<int>(fakers::nextRandom(state_) % static_cast<uint64_t>(bound)); }
+    bool chance(int percent) { return below(100) < percent; }
+
+private:
+    fakers::RandomState state_;
+};
+
+struct HeldKeys : fakers::InputIO {
+    std::bitset<16> keys;
+    std::bitset<16> read() override { return keys; }
+};
+
+// The plain CHIP-8 instructions, which generated ROMs are made of.
+constexpr Op CHIP8_OPS[] = {
+    Op::Cls, Op::Ret, Op::Sys, Op::Jump, Op::Call, Op::SkipEqImm, Op::SkipNeImm, Op::SkipEqReg,
+    Op::LoadImm, Op::AddImm, Op::Move, Op::Or, Op::And, Op::Xor, Op::Add, Op::Sub, Op::ShiftRight,
+    Op::SubReverse, Op::ShiftLeft, Op::SkipNeReg, Op::LoadI, Op::JumpIndexed, Op::Rand, Op::Draw,
+    Op::SkipKey, Op::SkipNoKey, Op::GetDelay, Op::WaitKey, Op::SetDelay, Op::SetSound, Op::AddI,
+    Op::Font, Op::Bcd, Op::Store, Op::Load,
+};
+// What SUPER-CHIP adds; Dxy0 is a Draw.
+constexpr Op SUPER_CHIP_OPS[] = {
+    Op::ScrollDown, Op::ScrollRight, Op::ScrollLeft, Op::Exit, Op::LowRes, Op::HighRes, Op::BigFont,
+    Op::SaveFlags, Op::LoadFlags,
+};
+// What XO-CHIP adds on top.
+constexpr Op XO_CHIP_OPS[] = {
+    Op::ScrollUp, Op::StoreRange, Op::LoadRange, Op::LoadLongI, Op::SelectPlanes,
+};
+
+// Skips next to stores into the program: a skip whose target a store just
+// rewrote, or that jumps into the middle of a cached block.
+const std::vector<Op> SKIPS_AND_WRITES = {
+    Op::SkipEqImm, Op::SkipNeImm, Op::SkipEqReg, Op::SkipNeReg, Op::Bcd, Op::Store, Op::LoadI,
+};
+
+// The instructions of a machine with the SUPER-CHIP (`extended`) and
+// XO-CHIP (`xo`) opcodes.
+std::vector<Op> machineOps(bool extended, bool xo) {
+    // Appended one by one: GCC misreads range insert() here as an
+    // out-of-bounds memcpy (-Wstringop-overread, -Warray-bounds).
+    std::vector<Op> ops(std::begin(CHIP8_OPS), std::end(CHIP8_OPS));
+    if (extended) {
+        for (Op op : SUPER_CHIP_OPS) {
+            ops.push_back(op);
+        }
+    }
+    if (xo) {
+        for (Op op : XO_CHIP_OPS) {
+            ops.push_back(op);
+        }
+    }
+    return ops;
+}
+
+// A random instance of `op`. Jumps and calls mostly land on instructions of
+// the program, so runs stay in generated code; I mostly points into the
+// program or the font, so Fx55 and friends rewrite code. F000's address is
+// whatever instruction is generated after it.
+int encode(Op op, Dice& dice, int programSize) {
+    int x = dice.below(16) << 8;
+    int y = dice.below(16) << 4;
+    int kk = dice.below(0x100);
+    auto target = [&] {
+        int offset = dice.below(programSize);
+        return static_cast<int>(fakers::MEM_START) + (dice.chance(90) ? offset & ~1 : offset);
+    };
+    auto sloppyNibble = [&] { return dice.chance(90) ? 0 : dice.below(16); };
+    switch (op) {
+    case Op::Cls: return 0x00E0;
+    case Op::Ret: return 0x00EE;
+    case Op::Sys: return target();
+    case Op::Jump: return 0x1000 | target();
+    case Op::Call: return 0x2000 | target();
+    case Op::SkipEqImm: return 0x3000 | x | kk;
+    case Op::SkipNeImm: return 0x4000 | x | kk;
+    case Op::SkipEqReg: return 0x5000 | x | y | sloppyNibble();
+    case Op::LoadImm: return 0x6000 | x | kk;
+    case Op::AddImm: return 0x7000 | x | kk;
+    case Op::Move: return 0x8000 | x | y;
+    case Op::Or: return 0x8001 | x | y;
+    case Op::And: return 0x8002 | x | y;
+    case Op::Xor: return 0x8003 | x | y;
+    case Op::Add: return 0x8004 | x | y;
+    case Op::Sub: return 0x8005 | x | y;
+    case Op::ShiftRight: return 0x8006 | x | y;
+    case Op::SubReverse: return 0x8007 | x | y;
+    case Op::ShiftLeft: return 0x800E | x | y;
+    case Op::SkipNeReg: return 0x9000 | x | y | sloppyNibble();
+    case Op::LoadI:
+    {
+        int kind = dice.below(4);
+        return 0xA000 | (kind < 2 ? target() : kind == 2 ? dice.below(80) : dice.below(0x1000));
+    }
+    case Op::JumpIndexed: return 0xB000 | target();
+    case Op::Rand: return 0xC000 | x | kk;
+    case Op::Draw: return 0xD000 | x | y | dice.below(16);
+    case Op::SkipKey: return 0xE09E | x;
+    case Op::SkipNoKey: return 0xE0A1 | x;
+    case Op::GetDelay: return 0xF007 | x;
+    case Op::WaitKey: return 0xF00A | x;
+    case Op::SetDelay: return 0xF015 | x;
+    case Op::SetSound: return 0xF018 | x;
+    case Op::AddI: return 0xF01E | x;
+    case Op::Font: return 0xF029 | x;
+    case Op::Bcd: return 0xF033 | x;
+    case Op::Store: return 0xF055 | x;
+    case Op::Load: return 0xF065 | x;
+    case Op::ScrollDown: return 0x00C0 | dice.below(16);
+    case Op::ScrollUp: return 0x00D0 | dice.below(16);
+    case Op::ScrollRight: return 0x00FB;
+    case Op::ScrollLeft: return 0x00FC;
+    case Op::Exit: return 0x00FD;
+    case Op::LowRes: return 0x00FE;
+    case Op::HighRes: return 0x00FF;
+    case Op::BigFont: return 0xF030 | x;
+    case Op::SaveFlags: return 0xF075 | x;
+    case Op::LoadFlags: return 0xF085 | x;
+    case Op::StoreRange: return 0x5002 | x | y;
+    case Op::LoadRange: return 0x5003 | x | y;
+    case Op::LoadLongI: return 0xF000;
+    case Op::SelectPlanes: return 0xF001 | x;
+    default: return dice.below(0x10000);
+    }
+}
+
+// A program of random instructions from `ops`, one in fifty a random word.
+// With a focus, half of them are drawn from it instead.
+std::vector<uint8_t> generateRom(uint64_t seed, std::vector<Op> const& focus, std::vector<Op> const& ops) {
+    Dice dice{ seed };
+    int size = 2 * (16 + dice.below(240));
+    std::vector<uint8_t> rom;
+    rom.reserve(size);
+    while (static_cast<int>(rom.size()) < size) {
+        Op op = !focus.empty() && dice.chance(50) ? focus[dice.below(static_cast<int>(focus.size()))]
+            : dice.chance(2) ? Op::Unknown : ops[dice.below(static_cast<int>(ops.size()))];
+        int opcode = encode(op, dice, size);
+        rom.push_back(static_cast<uint8_t>(opcode >> 8));
+        rom.push_back(static_cast<uint8_t>(opcode));
+    }
+    return rom;
+}
+
+// Mostly nothing held, sometimes one key, now and then a handful.
+std::bitset<16> randomKeys(Dice& dice) {
+    int kind = dice.below(4);
+    if (kind < 2) {
+        return {};
+    }
+    if (kind == 2) {
+        return std::bitset<16>{}.set(dice.below(16));
+    }
+    return std::bitset<16>(static_cast<unsigned long>(dice.below(0x10000)));
+}
+
+std::string hex(int value) {
+    std::ostringstream os;
+    os << "0x" << std::hex << value;
+    return os.str();
+}
+
+std::string mismatch(std::string const& what, int actual, int expected) {
+    return what + "=" + hex(actual) + ", reference " + hex(expected);
+}
+
+// Names the first differing row, plane by plane on XO-CHIP.
+template <typename Display>
+std::string displayDifference(Display const& expected, Display const& actual) {
+    if constexpr (std::is_same_v<Display, fakers::XoChipModel::Display>) {
+        for (size_t plane = 0; plane < expected.size(); ++plane) {
+            if (actual[plane] != expected[plane]) {
+                return "plane " + std::to_string(plane) + " " + displayDifference(expected[plane], actual[plane]);
+            }
+        }
+    } else {
+        for (size_t row = 0; row < expected.size(); ++row) {
+            if (actual[row] != expected[row]) {
+                return "display row " + std::to_string(row) + " differs";
+            }
+        }
+    }
+    return {};
+}
+
+// Compares what FakeChip8 and LockstepChip8 lanes both expose; empty when
+// equal.
+template <typename State, typename View>
+std::string firstDifference(State const& expected, View const& actual) {
+    if (actual.pc() != expected.pc) {
+        return mismatch("pc", actual.pc(), expected.pc);
+    }
+    if (actual.regI() != expected.regI) {
+        return mismatch("I", actual.regI(), expected.regI);
+    }
+    for (size_t r = 0; r < fakers::REGISTER_COUNT; ++r) {
+        if (actual.registers()[r] != expected.v[r]) {
+            return mismatch("V" + hex(static_cast<int>(r)).substr(2), actual.registers()[r], expected.v[r]);
+        }
+    }
+    for (size_t address = 0; actual.memory() != expected.memory && address < expected.memory.size(); ++address) {
+        if (actual.memory()[address] != expected.memory[address]) {
+            return mismatch("memory[" + hex(static_cast<int>(address)) + "]", actual.memory()[address],
+                expected.memory[address]);
+        }
+    }
+    return displayDifference(expected.display, actual.display());
+}
+
+// The rest of the machine, which only FakeChip8 lets us see.
+template <typename State>
+std::string hiddenDifference(State const& expected, State const& actual) {
+    if (actual.delayTimer != expected.delayTimer) {
+        return mismatch("delay timer", actual.delayTimer, expected.delayTimer);
+    }
+    if (actual.soundTimer != expected.soundTimer) {
+        return mismatch("sound timer", actual.soundTimer, expected.soundTimer);
+    }
+    if (actual.sp != expected.sp) {
+        return mismatch("sp", actual.sp, expected.sp);
+    }
+    for (size_t i = 0; i < expected.sp; ++i) {
+        if (actual.stack[i] != expected.stack[i]) {
+            return mismatch("stack[" + std::to_string(i) + "]", actual.stack[i], expected.stack[i]);
+        }
+    }
+    if (actual.waitingForKey != expected.waitingForKey) {
+        return mismatch("waiting for key", actual.waitingForKey, expected.waitingForKey);
+    }
+    if (actual.waitingForKey && actual.keyRegister != expected.keyRegister) {
+        return mismatch("key register", actual.keyRegister, expected.keyRegister);
+    }
+    if (actual.random.words != expected.random.words) {
+        return "Cxkk generator state differs";
+    }
+    if (actual.hiRes != expected.hiRes) {
+        return mismatch("high resolution", actual.hiRes, expected.hiRes);
+    }
+    if (actual.planeMask != expected.planeMask) {
+        return mismatch("planes", actual.planeMask, expected.planeMask);
+    }
+    for (size_t i = 0; i < fakers::FLAG_COUNT; ++i) {
+        if (actual.flags[i] != expected.flags[i]) {
+            return mismatch("flag " + std::to_string(i), actual.flags[i], expected.flags[i]);
+        }
+    }
+    return {};
+}
+
+struct Failure {
+    std::string engine;
+    uint64_t step;
+    int pc;
+    int opcode;
+    std::string what;
+};
+
+struct Stats {
+    uint64_t roms = 0;
+    uint64_t instructions = 0;
+    // Runs that ended with every engine throwing, e.g. on 00EE.
+    uint64_t throws = 0;
+    std::array<uint64_t, static_cast<size_t>(Op::Count)> executed{};
+};
+
+// Runs f() and returns its exception's message, if any.
+template <typename F>
+std::optional<std::string> attempt(F&& f) {
+    try {
+        f();
+    } catch (std::exception& e) {
+        return std::string{ e.what() };
+    }
+    return std::nullopt;
+}
+
+// Steps `core` after the reference machine ran the same instruction and
+// describes how they disagree; empty when they agree.
+template <typename Core, typename State>
+std::string compareStep(Core& core, State const& expected, bool expectedRunning,
+    std::optional<std::string> const& expectedError) {
+    bool running = false;
+    auto error = attempt([&] { running = core.step(); });
+    if (error.has_value() != expectedError.has_value()) {
+        return error ? "threw \"" + *error + "\"" : "did not throw \"" + *expectedError + "\"";
+    }
+    if (error) {
+        return {};
+    }
+    if (running != expectedRunning) {
+        return running ? "still running" : "halted";
+    }
+    auto what = firstDifference(expected, core);
+    return what.empty() ? hiddenDifference(expected, core.state()) : what;
+}
+
+// Runs an interpreter and a block-engine `Core` over `rom` in runCycles()
+// slices of random length, with the keys changing between slices, and
+// compares the results and the whole machines after each. Unlike step(),
+// slices let the block engine chain blocks and stop inside one.
+template <typename Core>
+std::optional<Failure> compareSlices(std::vector<uint8_t> const& rom, uint64_t seed, uint64_t steps) {
+    Dice dice{ seed ^ SLICE_STREAM };
+    HeldKeys keys;
+    Core interpreter{ fakers::Engine::Interpreter };
+    Core blocks{ fakers::Engine::CachedBlocks };
+    for (Core* core : { &interpreter, &blocks }) {
+        core->attachIO(&keys);
+        core->seed(seed);
+        core->load(rom);
+    }
+
+    uint64_t nextTick = TIMER_PERIOD;
+    for (uint64_t step = 0; step < steps;) {
+        if (dice.below(KEY_CHANGE / TIMER_PERIOD) == 0) {
+            keys.keys = randomKeys(dice);
+        }
+        // Mostly shorter than a block, now and then many of them.
+        auto budget = static_cast<uint32_t>(1 + (dice.chance(75) ? dice.below(16) : dice.below(1000)));
+        int pc = interpreter.pc();
+        std::optional<fakers::RunResult> expected;
+        std::optional<fakers::RunResult> actual;
+        auto expectedError = attempt([&] { expected = interpreter.runCycles(budget); });
+        auto error = attempt([&] { actual = blocks.runCycles(budget); });
+        std::string what;
+        if (error.has_value() != expectedError.has_value()) {
+            what = error ? "threw \"" + *error + "\"" : "did not throw \"" + *expectedError + "\"";
+        } else if (error) {
+            return std::nullopt;
+        } else if (actual->reason != expected->reason) {
+            what = mismatch("stop reason", static_cast<int>(actual->reason), static_cast<int>(expected->reason));
+        } else if (actual->cycles != expected->cycles) {
+            what = mismatch("cycles", static_cast<int>(actual->cycles), static_cast<int>(expected->cycles));
+        } else {
+            what = firstDifference(interpreter.state(), blocks);
+            if (what.empty()) {
+                what = hiddenDifference(interpreter.state(), blocks.state());
+            }
+        }
+        if (!what.empty()) {
+            return Failure{ "blocks in slices", step, -1, -1,
+                "slice of " + std::to_string(budget) + " from " + hex(pc) + ": " + what };
+        }
+        if (expected->reason == fakers::StopReason::Halted) {
+            return std::nullopt;
+        }
+        // A machine waiting on Fx0A spends the slice idle.
+        step += expected->cycles ? expected->cycles : budget;
+        for (; nextTick <= step; nextTick += TIMER_PERIOD) {
+            interpreter.tickTimers();
+            blocks.tickTimers();
+        }
+    }
+    return std::nullopt;
+}
+
+// Steps the reference and every fast engine built for the profile one
+// instruction at a time over `rom`, comparing them after each. Both
+// FakeChip8 engines run the reference's machine; the lockstep engine, which
+// only knows the legacy profile, runs LOCKSTEP_LANES machines seeded and
+// keyed differently against a reference each. Then compareSlices().
+template <typename Quirks>
+std::optional<Failure> fuzzRom(std::vector<uint8_t> const& rom, uint64_t seed, uint64_t steps, Stats& stats) {
+    using Core = fakers::BasicFakeChip8<fakers::NoTrace, fakers::Chip8Model, Quirks>;
+    constexpr bool LOCKSTEP = std::is_same_v<Quirks, fakers::LegacyQuirks>;
+    ++stats.roms;
+
+    Dice dice{ seed ^ KEY_STREAM };
+    HeldKeys keys;
+    fakers::ReferenceChip8<Quirks> reference;
+    reference.load(rom.data(), rom.size(), seed);
+    Core interpreter{ fakers::Engine::Interpreter };
+    Core blocks{ fakers::Engine::CachedBlocks };
+    std::pair<char const*, Core*> const cores[] = { { "interpreter", &interpreter }, { "blocks", &blocks } };
+    for (auto [name, core] : cores) {
+        core->attachIO(&keys);
+        core->seed(seed);
+        core->load(rom);
+    }
+
+    fakers::LockstepChip8 lockstep{ LOCKSTEP ? LOCKSTEP_LANES : 0 };
+    std::array<fakers::ReferenceChip8<fakers::LegacyQuirks>, LOCKSTEP_LANES> laneReferences;
+    std::array<std::bitset<16>, LOCKSTEP_LANES> laneKeys;
+    if constexpr (LOCKSTEP) {
+        for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+            lockstep.seed(lane, seed + lane);
+            laneReferences[lane].load(rom.data(), rom.size(), seed + lane);
+        }
+        lockstep.load(rom);
+    }
+
+    bool coresDone = false;
+    bool lanesDone = !LOCKSTEP;
+    for (uint64_t step = 0; step < steps && !(coresDone && lanesDone); ++step) {
+        if (dice.below(KEY_CHANGE) == 0) {
+            keys.keys = randomKeys(dice);
+            for (auto& held : laneKeys) {
+                held = randomKeys(dice);
+            }
+        }
+        if (step % TIMER_PERIOD == TIMER_PERIOD - 1) {
+            reference.tickTimers();
+            interpreter.tickTimers();
+            blocks.tickTimers();
+            lockstep.tickTimers();
+            for (auto& laneReference : laneReferences) {
+                laneReference.tickTimers();
+            }
+        }
+
+        if (!coresDone) {
+            auto const& state = reference.state();
+            int pc = state.pc;
+            int opcode = state.memory[pc] << 8 | state.memory[pc + 1];
+            if (!state.waitingForKey || keys.keys.any()) {
+                ++stats.instructions;
+                ++stats.executed[static_cast<size_t>(fakers::decodeOp(opcode, false, false))];
+            }
+            bool expectedRunning = false;
+            auto expectedError = attempt([&] { expectedRunning = reference.step(keys.keys); });
+            for (auto [name, core] : cores) {
+                auto what = compareStep(*core, reference.state(), expectedRunning, expectedError);
+                if (!what.empty()) {
+                    return Failure{ name, step, pc, opcode, what };
+                }
+            }
+            stats.throws += expectedError.has_value();
+            coresDone = expectedError || !expectedRunning;
+        }
+
+        if constexpr (LOCKSTEP) {
+            if (lanesDone) {
+                continue;
+            }
+            std::optional<std::string> expectedError;
+            std::array<int, LOCKSTEP_LANES> pcs;
+            std::array<int, LOCKSTEP_LANES> opcodes;
+            for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+                auto const& state = laneReferences[lane].state();
+                pcs[lane] = state.pc;
+                opcodes[lane] = state.memory[state.pc % fakers::MEM_SIZE] << 8
+                    | state.memory[(state.pc + 1) % fakers::MEM_SIZE];
+                lockstep.setKeys(lane, laneKeys[lane]);
+                if (!laneReferences[lane].halted()) {
+                    if (auto error = attempt([&] { laneReferences[lane].step(laneKeys[lane]); })) {
+                        expectedError = error;
+                    }
+                }
+            }
+            auto error = attempt([&] { lockstep.runCycles(1); });
+            if (error.has_value() != expectedError.has_value()) {
+                return Failure{ "lockstep", step, -1, -1,
+                    error ? "threw \"" + *error + "\"" : "did not throw \"" + *expectedError + "\"" };
+            }
+            if (error) {
+                lanesDone = true;
+                continue;
+            }
+            lanesDone = true;
+            for (size_t lane = 0; lane < LOCKSTEP_LANES; ++lane) {
+                std::string what = lockstep.halted(lane) != laneReferences[lane].halted()
+                    ? (lockstep.halted(lane) ? "halted" : "still running")
+                    : firstDifference(laneReferences[lane].state(), lockstep.lane(lane));
+                if (!what.empty()) {
+                    return Failure{ "lockstep lane " + std::to_string(lane), step, pcs[lane], opcodes[lane], what };
+                }
+                lanesDone &= laneReferences[lane].halted();
+            }
+        }
+    }
+    return compareSlices<Core>(rom, seed, steps);
+}
+
+// SUPER-CHIP and XO-CHIP machines have no reference interpreter: the
+// block engine is stepped against the interpreter instead, over programs
+// that use the machine's own instructions too, then in slices.
+template <typename Model>
+std::optional<Failure> fuzzMachine(std::vector<uint8_t> const& rom, uint64_t seed, uint64_t steps, Stats& stats) {
+    using Core = fakers::BasicFakeChip8<fakers::NoTrace, Model>;
+    ++stats.roms;
+
+    Dice dice{ seed ^ KEY_STREAM };
+    HeldKeys keys;
+    Core interpreter{ fakers::Engine::Interpreter };
+    Core blocks{ fakers::Engine::CachedBlocks };
+    for (Core* core : { &interpreter, &blocks }) {
+        core->attachIO(&keys);
+        core->seed(seed);
+        core->load(rom);
+    }
+
+    for (uint64_t step = 0; step < steps; ++step) {
+        if (dice.below(KEY_CHANGE) == 0) {
+            keys.keys = randomKeys(dice);
+        }
+        if (step % TIMER_PERIOD == TIMER_PERIOD - 1) {
+            interpreter.tickTimers();
+            blocks.tickTimers();
+        }
+        auto const& state = interpreter.state();
+        int pc = state.pc;
+        int opcode = state.memory[pc] << 8 | state.memory[pc + 1];
+        if (!state.waitingForKey || keys.keys.any()) {
+            ++stats.instructions;
+            ++stats.executed[static_cast<size_t>(fakers::decodeOp(opcode, Model::EXTENDED, Model::XO))];
+        }
+        bool expectedRunning = false;
+        auto expectedError = attempt([&] { expectedRunning = interpreter.step(); });
+        auto what = compareStep(blocks, interpreter.state(), expectedRunning, expectedError);
+        if (!what.empty()) {
+            return Failure{ "blocks", step, pc, opcode, what };
+        }
+        stats.throws += expectedError.has_value();
+        if (expectedError || !expectedRunning) {
+            break;
+        }
+    }
+    return compareSlices<Core>(rom, seed, steps);
+}
+
+struct Profile {
+    char const* name;
+    std::optional<Failure> (*fuzz)(std::vector<uint8_t> const&, uint64_t, uint64_t, Stats&);
+    // The machine's opcodes, as decodeOp() takes them.
+    bool extended;
+    bool xo;
+};
+
+// CHIP-8 under each quirk profile, then the SUPER-CHIP and XO-CHIP machines.
+constexpr Profile PROFILES[] = {
+    { "legacy", &fuzzRom<fakers::LegacyQuirks>, false, false },
+    { "vip", &fuzzRom<fakers::CosmacVipQuirks>, false, false },
+    { "chip48", &fuzzRom<fakers::Chip48Quirks>, false, false },
+    { "schip", &fuzzRom<fakers::SuperChipQuirks>, false, false },
+    { "xochip", &fuzzRom<fakers::XoChipQuirks>, false, false },
+    { "SuperChip8", &fuzzMachine<fakers::SuperChipModel>, true, false },
+    { "XoChip8", &fuzzMachine<fakers::XoChipModel>, true, true },
+};
+
+void reportFailure(Failure const& failure, Profile const& profile, uint64_t seed) {
+    std::cerr << "MISMATCH quirks=" << profile.name << " seed=" << seed << " engine=" << failure.engine
+        << " step=" << failure.step;
+    if (failure.pc >= 0) {
+        fakers::Op op = fakers::decodeOp(failure.opcode, profile.extended, profile.xo);
+        std::cerr << " at " << hex(failure.pc) << " " << hex(failure.opcode) << " "
+            << fakers::formatInstruction({ failure.pc, failure.opcode, op, 0 });
+    }
+    std::cerr << ": " << failure.what << "\n";
+}
+
+} // namespace
+
+#ifdef FAKE_CHIP8_LIBFUZZER
+
+// libFuzzer feeds the ROM; the seed stays fixed so a crash input replays.
+extern "C" int LLVMFuzzerTestOneInput(uint8_t const* data, size_t size) {
+    if (size > fakers::MAX_PROGRAM_SIZE) {
+        return 0;
+    }
+    std::vector<uint8_t> rom(data, data + size);
+    Stats stats;
+    for (auto const& profile : PROFILES) {
+        if (auto failure = profile.fuzz(rom, DEFAULT_FIRST_SEED, DEFAULT_STEPS, stats)) {
+            reportFailure(*failure, profile, DEFAULT_FIRST_SEED);
+            std::abort();
+        }
+    }
+    return 0;
+}
+
+#else
+
+int main(int argc, char** argv) {
+    uint64_t firstSeed = DEFAULT_FIRST_SEED;
+    uint64_t roms = DEFAULT_ROMS;
+    uint64_t steps = DEFAULT_STEPS;
+    std::string_view quirks;
+    std::string romPath;
+    std::string savePath;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            firstSeed = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--roms" && i + 1 < argc) {
+            roms = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "-n" && i + 1 < argc) {
+            steps = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--quirks" && i + 1 < argc) {
+            quirks = argv[++i];
+        } else if (arg == "--save" && i + 1 < argc) {
+            savePath = argv[++i];
+        } else if (arg == "--rom" && i + 1 < argc) {
+            romPath = argv[++i];
+        } else {
+            std::cerr << "<program> [--seed <first>] [--roms <count>] [-n <steps>]"
+                " [--quirks <legacy|vip|chip48|schip|xochip|SuperChip8|XoChip8>] [--save <romPath>] [--rom <romPath>]\n";
+            return -1;
+        }
+    }
+
+    std::vector<uint8_t> fixedRom;
+    if (!romPath.empty()) {
+        fakers::MappedFile file{ romPath };
+        fixedRom.assign(file.data(), file.data() + file.size());
+        roms = 1;
+    }
+
+    Stats stats;
+    int status = 0;
+    bool extended = false;
+    bool xo = false;
+    for (uint64_t i = 0; i < roms && status == 0; ++i) {
+        uint64_t seed = firstSeed + i;
+        for (auto const& profile : PROFILES) {
+            if (!quirks.empty() && quirks != profile.name) {
+                continue;
+            }
+            extended |= profile.extended;
+            xo |= profile.xo;
+            auto ops = machineOps(profile.extended, profile.xo);
+            // Every other ROM concentrates on one instruction, in turn, and
+            // one in four on skips and self-modifying stores.
+            std::vector<Op> focus;
+            if (seed % 2) {
+                focus = { ops[seed / 2 % ops.size()] };
+            } else if (seed % 4 == 2) {
+                focus = SKIPS_AND_WRITES;
+            }
+            auto rom = romPath.empty() ? generateRom(seed, focus, ops) : fixedRom;
+            std::optional<Failure> failure;
+            try {
+                failure = profile.fuzz(rom, seed, steps, stats);
+            } catch (std::exception& e) {
+                failure = Failure{ "setup", 0, -1, -1, e.what() };
+            }
+            if (failure) {
+                reportFailure(*failure, profile, seed);
+                std::cerr << "replay: --quirks " << profile.name << " --seed " << seed << " --roms 1\n";
+                if (!savePath.empty()) {
+                    std::ofstream{ savePath, std::ios::binary }.write(reinterpret_cast<char const*>(rom.data()),
+                        rom.size());
+                }
+                status = 1;
+                break;
+            }
+        }
+    }
+
+    size_t covered = 0;
+    std::string missing;
+    auto ops = machineOps(extended, xo);
+    for (Op op : ops) {
+        if (stats.executed[static_cast<size_t>(op)]) {
+            ++covered;
+        } else {
+            missing += std::string{ " " } + fakers::opInfo(op).syntax;
+        }
+    }
+    std::cout << "roms=" << stats.roms << " instructions=" << stats.instructions << " throws=" << stats.throws
+        << " unknown=" << stats.executed[static_cast<size_t>(Op::Unknown)]
+        << " ops=" << covered << "/" << ops.size() << (status ? " FAILED" : " OK") << "\n";
+    if (status == 0 && !missing.empty()) {
+        std::cout << "never executed:" << missing << "\n";
+    }
+    return status;
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "FrameHandoff.h"
+#include "KeyEventQueue.h"
+#include "MachineState.h"
+
+// Hammers the frame and key handoff between an emulator-like producer and a
+// GUI-like consumer. Build with -DFAKE_CHIP8_TSAN=ON to have ThreadSanitizer
+// watch it; the checks below catch torn or reordered frames and lost key
+// events either way.
+namespace
+{
+uint64_t rowPattern(uint64_t frame, size_t row) {
+    return frame ^ (row * 0x9e3779b97f4a7c15ull);
+}
+
+constexpr int WAKE_ROUNDS = 200;
+
+// Parks a thread in KeyEventQueue::waitForKey as a core blocked on Fx0A
+// does, taps a key from this one and times press to wake-up. Returns the
+// latencies in ascending order; a wait that runs into its deadline counts
+// as a miss.
+std::vector<std::chrono::nanoseconds> wakeLatencies(int rounds, uint64_t& misses) {
+    using Clock = std::chrono::steady_clock;
+    fakers::KeyEventQueue keys;
+    std::atomic<Clock::rep> pressedAt{ 0 };
+    std::atomic<int> parked{ -1 };
+    std::vector<std::chrono::nanoseconds> latencies;
+    std::thread emulator{ [&] {
+        for (int round = 0; round < rounds; ++round) {
+            parked = round;
+            bool woke = keys.waitForKey(Clock::now() + std::chrono::seconds{ 1 });
+            auto now = Clock::now().time_since_epoch().count();
+            if (!woke) {
+                ++misses;
+                continue;
+            }
+            latencies.emplace_back(Clock::duration{ now - pressedAt.load() });
+            // Take the press and the release so the next round parks again.
+            for (size_t taken = 0; taken < 2; taken += keys.deliver(round)) {
+                std::this_thread::yield();
+            }
+        }
+    } };
+    for (int round = 0; round < rounds; ++round) {
+        while (parked != round) {
+            std::this_thread::yield();
+        }
+        // Give the other thread time to actually fall asleep.
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+        pressedAt = Clock::now().time_since_epoch().count();
+        keys.push(round & 0xf, true);
+        keys.push(round & 0xf, false);
+    }
+    emulator.join();
+    std::sort(begin(latencies), end(latencies));
+    return latencies;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t frames = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 1000000;
+
+    fakers::TripleBuffer<fakers::Framebuffer> handoff;
+    fakers::KeyEventQueue keys;
+    std::atomic<bool> done{ false };
+    uint64_t badKeys = 0;
+    uint64_t delivered = 0;
+
+    // Emulator side: publishes every frame and takes the key events, as
+    // presentFrame() and the runner's deliver() do.
+    std::thread emulator{ [&] {
+        for (uint64_t frame = 1; frame <= frames; ++frame) {
+            auto& back = handoff.back();
+            for (size_t row = 0; row < back.size(); ++row) {
+                back[row] = rowPattern(frame, row);
+            }
+            handoff.publish();
+            delivered += keys.deliver(frame);
+            // The GUI side never holds more than one key at a time.
+            if (keys.read().count() > 1) {
+                ++badKeys;
+            }
+        }
+        done = true;
+    } };
+
+    // GUI side: takes whatever frame is newest and presses keys meanwhile.
+    uint64_t seen = 0;
+    uint64_t last = 0;
+    uint64_t torn = 0;
+    uint64_t backwards = 0;
+    uint64_t pushed = 0;
+    uint64_t dropped = 0;
+    int key = 0;
+    bool down = false;
+    auto consume = [&] {
+        if (!handoff.acquire()) {
+            return;
+        }
+        auto const& front = handoff.front();
+        uint64_t frame = front[0];
+        for (size_t row = 1; row < front.size(); ++row) {
+            if (front[row] != rowPattern(frame, row)) {
+                ++torn;
+                break;
+            }
+        }
+        if (frame <= last) {
+            ++backwards;
+        }
+        last = frame;
+        ++seen;
+    };
+    while (!done) {
+        consume();
+        // A full queue drops a press; a release is retried until it fits,
+        // as a key held down must come up again.
+        if (!down && !(down = keys.push(key, true))) {
+            ++dropped;
+        }
+        if (down && keys.push(key, false)) {
+            pushed += 2;
+            down = false;
+            key = (key + 1) & 0xf;
+        }
+    }
+    emulator.join();
+    consume();
+    auto drain = [&] {
+        for (size_t taken; (taken = keys.deliver(frames + 1)) != 0;) {
+            delivered += taken;
+        }
+    };
+    drain();
+    if (down) {
+        keys.push(key, false);
+        pushed += 2;
+        drain();
+    }
+    uint64_t lost = pushed - delivered;
+    bool stuck = keys.read().any();
+
+    std::cout << "published " << frames << " frames, consumer saw " << seen
+              << ", last " << last << ", torn " << torn << ", backwards " << backwards
+              << ", bad key reads " << badKeys << '\n'
+              << "pushed " << pushed << " key events, delivered " << delivered << ", lost " << lost
+              << ", presses dropped on a full queue " << dropped << (stuck ? ", key left down" : "") << '\n';
+
+    uint64_t missedWakes = 0;
+    auto latencies = wakeLatencies(WAKE_ROUNDS, missedWakes);
+    if (!latencies.empty()) {
+        auto micros = [](std::chrono::nanoseconds ns) { return ns.count() / 1000.0; };
+        std::cout << "key wake-up: median " << micros(latencies[latencies.size() / 2]) << " us, worst "
+                  << micros(latencies.back()) << " us over " << latencies.size() << " presses, "
+                  << missedWakes << " missed\n";
+    }
+    if (torn || backwards || badKeys || last != frames || lost || stuck || missedWakes) {
+        std::cerr << "FAILED\n";
+        return 1;
+    }
+}
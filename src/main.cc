@@ -1,14 +1,194 @@
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
+#include "FakeChip8HeadlessRunner.h"
 #include "FakeChip8Runner.h"
+#include "KeyEventQueue.h"
+#include "Snapshot.h"
+#include "TraceRecorder.h"
 
 int main(int argc, char** argv) {
-    srand(time(NULL));
+    fakers::SchedulerConfig config;
+    fakers::Engine engine = fakers::Engine::Interpreter;
+    fakers::Renderer renderer = fakers::Renderer::Rectangles;
+    fakers::Machine machine = fakers::Machine::Chip8;
+    fakers::QuirkProfile quirks = fakers::QuirkProfile::Default;
+    std::optional<fakers::MachineState> initialState;
+    std::string_view saveStatePath;
+    std::string profilePath;
+    std::string recordKeysPath;
+    std::vector<fakers::KeyEvent> replayKeys;
+    uint64_t seed = fakers::DEFAULT_SEED;
+    while (argc >= 2) {
+        std::string_view option = argv[1];
+        if (option == "--hz" && argc >= 3) {
+            config.cyclesPerSecond = std::strtoul(argv[2], nullptr, 0);
+            argc -= 2;
+            argv += 2;
+        } else if (option == "--seed" && argc >= 3) {
+            seed = std::strtoull(argv[2], nullptr, 0);
+            argc -= 2;
+            argv += 2;
+        } else if (option == "--blocks") {
+            engine = fakers::Engine::CachedBlocks;
+            argc -= 1;
+            argv += 1;
+        } else if (option == "--machine" && argc >= 3) {
+            std::string_view name = argv[2];
+            if (name == "schip") {
+                machine = fakers::Machine::SuperChip;
+            } else if (name == "xochip") {
+                machine = fakers::Machine::XoChip;
+            } else if (name != "chip8") {
+                std::cerr << "unknown machine " << name << " (chip8, schip or xochip)\n";
+                return -1;
+            }
+            argc -= 2;
+            argv += 2;
+        } else if (option == "--quirks" && argc >= 3) {
+            auto profile = fakers::quirkProfileNamed(argv[2]);
+            if (!profile) {
+                std::cerr << "unknown quirks " << argv[2] << " (vip, chip48, schip or xochip)\n";
+                return -1;
+            }
+            quirks = *profile;
+            argc -= 2;
+            argv += 2;
+        } else if (option == "--texture") {
+            renderer = fakers::Renderer::Texture;
+            argc -= 1;
+            argv += 1;
+        } else if (option == "--max-speed") {
+            config.maxSpeed = true;
+            argc -= 1;
+            argv += 1;
+        } else if (option == "--load-state" && argc >= 3) {
+            std::ifstream in{ std::string{ argv[2] }, std::ios::binary };
+            if (!in) {
+                std::cerr << "cannot open " << argv[2] << '\n';
+                return -1;
+            }
+            try {
+                initialState = fakers::readSnapshot(in);
+            } catch (std::runtime_error& e) {
+                std::cerr << argv[2] << ": " << e.what() << '\n';
+                return -1;
+            }
+            argc -= 2;
+            argv += 2;
+        } else if (option == "--save-state" && argc >= 3) {
+            saveStatePath = argv[2];
+            argc -= 2;
+            argv += 2;
+        } else if (option == "--record-keys" && argc >= 3) {
+            recordKeysPath = argv[2];
+            argc -= 2;
+            argv += 2;
+        } else if (option == "--replay-keys" && argc >= 3) {
+            std::ifstream in{ argv[2] };
+            if (!in) {
+                std::cerr << "cannot open " << argv[2] << '\n';
+                return -1;
+            }
+            replayKeys = fakers::keyScript(fakers::readKeyLog(in));
+            argc -= 2;
+            argv += 2;
+        } else if (option == "--profile" && argc >= 3) {
+            profilePath = argv[2];
+            argc -= 2;
+            argv += 2;
+        } else {
+            break;
+        }
+    }
+    if (machine != fakers::Machine::Chip8 && (initialState || !saveStatePath.empty())) {
+        std::cerr << "save states are only supported for chip8\n";
+        return -1;
+    }
+    if (argc >= 3 && std::string_view{ argv[1] } == "--headless") {
+        uint64_t maxInstructions = argc > 3 ? std::strtoull(argv[3], nullptr, 0) : UINT64_MAX;
+        fakers::HeadlessConfig headless;
+        headless.cyclesPerSecond = config.cyclesPerSecond;
+        headless.engine = engine;
+        headless.initialState = initialState;
+        headless.seed = seed;
+        headless.input = replayKeys;
+        fakers::FakeChip8HeadlessRunner runner{ headless };
+        auto program = fakers::readRom(argv[2]);
+        fakers::HeadlessReport report;
+        if (profilePath.empty()) {
+            report = fakers::withCore<fakers::NoTrace>(machine, quirks, [&](auto core) {
+                return runner.run<typename decltype(core)::type>(program, maxInstructions);
+            });
+        } else {
+            auto profile = std::make_unique<fakers::ProfileCounters>();
+            report = fakers::withCore<fakers::Profiling>(machine, quirks, [&](auto core) {
+                return runner.run<typename decltype(core)::type>(program, maxInstructions, nullptr, profile.get());
+            });
+            fakers::writeProfile(profilePath, *profile);
+        }
+        std::cerr << report << '\n';
+        if (!saveStatePath.empty()) {
+            std::ofstream out{ std::string{ saveStatePath }, std::ios::binary };
+            fakers::writeSnapshot(out, report.finalState);
+        }
+        return 0;
+    }
+    if (!replayKeys.empty()) {
+        std::cerr << "--replay-keys needs --headless\n";
+        return -1;
+    }
+    if (!saveStatePath.empty()) {
+        std::cerr << "--save-state needs --headless\n";
+        return -1;
+    }
+    fakers::FakeChip8Runner f{ config, engine, renderer, machine, quirks };
+    f.seed(seed);
+    std::vector<fakers::KeyTransition> keyLog;
+    if (!recordKeysPath.empty()) {
+        f.recordKeysTo(&keyLog);
+    }
+    // Also written after an emulation error, so the failing session can be
+    // replayed.
+    auto writeKeyLog = [&] {
+        if (!recordKeysPath.empty()) {
+            std::ofstream out{ recordKeysPath };
+            fakers::writeKeyLog(out, keyLog);
+        }
+    };
+    if (initialState) {
+        f.startFrom(*initialState);
+    }
+    if (argc == 4 && std::string_view{ argv[1] } == "--trace") {
+        if (!profilePath.empty()) {
+            std::cerr << "--profile and --trace cannot be combined\n";
+            return -1;
+        }
+        fakers::TraceRecorder recorder{ argv[3] };
+        f.runTraced(argv[2], &recorder);
+        writeKeyLog();
+        return 0;
+    }
     if (argc != 2) {
         std::cerr << "Wrong number of arguments\n";
-        std::cerr << "<program> <romPath>";
+        std::cerr << "<program> [--hz <cyclesPerSecond>] [--seed <n>] [--max-speed] [--blocks] [--machine <chip8|schip|xochip>] [--quirks <vip|chip48|schip|xochip>] [--texture] [--load-state <file>] [--record-keys <file>] [--profile <file.json|file.csv>] <romPath>\n";
+        std::cerr << "<program> [--hz <cyclesPerSecond>] [--seed <n>] [--max-speed] [--blocks] [--machine <chip8|schip|xochip>] [--quirks <vip|chip48|schip|xochip>] [--texture] [--load-state <file>] [--record-keys <file>] --trace <romPath> <traceFile>\n";
+        std::cerr << "<program> [--hz <cyclesPerSecond>] [--seed <n>] [--blocks] [--machine <chip8|schip|xochip>] [--quirks <vip|chip48|schip|xochip>] [--load-state <file>] [--save-state <file>] [--replay-keys <file>] [--profile <file.json|file.csv>] --headless <romPath> [maxInstructions]";
         return -1;
     }
-    fakers::FakeChip8Runner f;
+    if (!profilePath.empty()) {
+        auto profile = std::make_unique<fakers::ProfileCounters>();
+        f.runProfiled(argv[1], profile.get());
+        fakers::writeProfile(profilePath, *profile);
+        writeKeyLog();
+        return 0;
+    }
     f.run(argv[1]);
-}
\ No newline at end of file
+    writeKeyLog();
+}
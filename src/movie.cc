@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FakeChip8HeadlessRunner.h"
+#include "KeyEventQueue.h"
+#include "RomReader.h"
+
+// Replays recorded input movies headless and checks them against golden
+// checkpoint files. For a ROM named `<name>` the movie is `<name>.keys` (a
+// --record-keys log, optional) and the golden file `<name>.golden`, both in
+// the --movies directory or else next to the ROM.
+namespace
+{
+constexpr uint64_t DEFAULT_CYCLES = 100'000;
+constexpr uint64_t DEFAULT_INTERVAL = 1'000;
+
+struct GoldenCheckpoint {
+    uint64_t cycle;
+    uint64_t display;
+    uint64_t registers;
+};
+
+std::vector<GoldenCheckpoint> readGolden(std::istream& is) {
+    std::vector<GoldenCheckpoint> golden;
+    std::string line;
+    for (int number = 1; std::getline(is, line); ++number) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields{ line };
+        GoldenCheckpoint checkpoint;
+        if (!(fields >> checkpoint.cycle >> std::hex >> checkpoint.display >> checkpoint.registers)) {
+            throw std::runtime_error("bad checkpoint on line " + std::to_string(number));
+        }
+        golden.push_back(checkpoint);
+    }
+    return golden;
+}
+
+void writeGolden(std::ostream& os, std::vector<fakers::Checkpoint> const& checkpoints) {
+    os << "# cycle display registers\n";
+    for (auto const& checkpoint : checkpoints) {
+        os << checkpoint.cycle << std::hex << ' ' << std::setw(16) << std::setfill('0') << checkpoint.display
+           << ' ' << std::setw(16) << checkpoint.registers << std::dec << std::setfill(' ') << '\n';
+    }
+}
+
+// Describes the first checkpoint that differs from the golden run, or
+// returns an empty string.
+std::string compare(std::vector<GoldenCheckpoint> const& golden, std::vector<fakers::Checkpoint> const& actual) {
+    for (size_t i = 0; i < golden.size() && i < actual.size(); ++i) {
+        if (golden[i].cycle != actual[i].cycle) {
+            return "checkpoint " + std::to_string(i) + " at cycle " + std::to_string(actual[i].cycle)
+                + ", golden has it at " + std::to_string(golden[i].cycle);
+        }
+        bool display = golden[i].display != actual[i].display;
+        bool registers = golden[i].registers != actual[i].registers;
+        if (display || registers) {
+            return std::string{ display && registers ? "display and registers" : display ? "display" : "registers" }
+                + " differ at cycle " + std::to_string(actual[i].cycle);
+        }
+    }
+    if (golden.size() != actual.size()) {
+        return std::to_string(actual.size()) + " checkpoints, golden has " + std::to_string(golden.size());
+    }
+    return {};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    fakers::HeadlessConfig config;
+    config.checkpointInterval = DEFAULT_INTERVAL;
+    uint64_t cycles = DEFAULT_CYCLES;
+    bool update = false;
+    std::string timesPath;
+    std::string moviesPath;
+    std::vector<std::string> romPaths;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            cycles = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--interval" && i + 1 < argc) {
+            config.checkpointInterval = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--blocks") {
+            config.engine = fakers::Engine::CachedBlocks;
+        } else if (arg == "--update") {
+            update = true;
+        } else if (arg == "--movies" && i + 1 < argc) {
+            moviesPath = argv[++i];
+        } else if (arg == "--times" && i + 1 < argc) {
+            timesPath = argv[++i];
+        } else {
+            romPaths.emplace_back(arg);
+        }
+    }
+    if (romPaths.empty() || config.checkpointInterval == 0) {
+        std::cerr << "<program> [-n cycles] [--interval cycles] [--seed s] [--blocks] [--update] [--movies <dir>] [--times <file.csv>] <roms...>\n";
+        return -1;
+    }
+
+    std::ofstream times;
+    if (!timesPath.empty()) {
+        times.open(timesPath);
+        times << "rom,cycle,ns\n";
+    }
+    int failures = 0;
+    for (auto const& romPath : romPaths) {
+        std::filesystem::path rom{ romPath };
+        auto movie = (moviesPath.empty() ? rom.parent_path() : std::filesystem::path{ moviesPath }) / rom.filename();
+        fakers::HeadlessReport report;
+        std::string error;
+        // readRom() prints a load banner; keep it out of the report.
+        std::ofstream devNull;
+        auto* coutBuffer = std::cout.rdbuf(devNull.rdbuf());
+        try {
+            auto runConfig = config;
+            if (std::ifstream keys{ movie.string() + ".keys" }) {
+                runConfig.input = fakers::keyScript(fakers::readKeyLog(keys));
+            }
+            report = fakers::FakeChip8HeadlessRunner{ runConfig }.run(fakers::readRom(romPath), cycles);
+        } catch (std::exception& e) {
+            error = e.what();
+        }
+        std::cout.rdbuf(coutBuffer);
+
+        auto goldenPath = movie.string() + ".golden";
+        if (error.empty() && update) {
+            std::ofstream golden{ goldenPath };
+            writeGolden(golden, report.checkpoints);
+            error = golden ? "" : "cannot write " + goldenPath;
+        } else if (error.empty()) {
+            std::ifstream golden{ goldenPath };
+            if (!golden) {
+                error = "no " + goldenPath + ", run with --update to create it";
+            } else {
+                try {
+                    error = compare(readGolden(golden), report.checkpoints);
+                } catch (std::exception& e) {
+                    error = goldenPath + ": " + e.what();
+                }
+            }
+        }
+
+        std::chrono::nanoseconds slowest{};
+        for (auto const& checkpoint : report.checkpoints) {
+            slowest = std::max(slowest, checkpoint.wallTime);
+            if (times.is_open()) {
+                times << romPath << ',' << checkpoint.cycle << ',' << checkpoint.wallTime.count() << '\n';
+            }
+        }
+        std::cout << std::fixed << std::setprecision(2) << romPath << ": "
+            << (!error.empty() ? "FAIL, " + error : update ? "updated" : "ok")
+            << ", " << report.checkpoints.size() << " checkpoints"
+            << ", ips=" << report.instructionsPerSecond()
+            << " ns/instr=" << report.nsPerInstruction()
+            << " slowest checkpoint=" << std::chrono::duration<double, std::micro>(slowest).count() << "us\n";
+        failures += !error.empty();
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "FakeChip8.h"
+#include "ReferenceChip8.h"
+
+// Single instructions with results worked out by hand. Each case runs on
+// ReferenceChip8 and both FakeChip8 engines under every quirk profile it
+// names, and for the schip and xochip profiles also on the SUPER-CHIP and
+// XO-CHIP machines.
+namespace
+{
+struct OpCase {
+    char const* name;
+    // Quirk profiles the expectations hold for; all of them when empty.
+    std::vector<std::string_view> quirks;
+    // Runs once, top to bottom, from 0x200.
+    std::vector<uint16_t> program;
+    // After the last instruction: (register, value) and (address, value).
+    std::vector<std::pair<int, int>> registers{};
+    std::vector<std::pair<int, int>> memory{};
+    std::optional<int> regI{};
+    // The last instruction throws instead.
+    bool throws = false;
+};
+
+// The profiles that write VF after Vx, so 8FyN leaves the flag in VF.
+const std::vector<std::string_view> FLAG_LAST = { "vip", "chip48", "schip", "xochip" };
+
+const std::vector<OpCase> CASES = {
+    { "8xy4 carries out of 0xFF", {}, { 0x60FF, 0x6101, 0x8014 }, { { 0x0, 0x00 }, { 0x1, 0x01 }, { 0xF, 0x01 } } },
+    { "8xy4 clears VF without a carry", {}, { 0x6F01, 0x60FE, 0x6101, 0x8014 }, { { 0x0, 0xFF }, { 0xF, 0x00 } } },
+    { "8Fy4 keeps the carry", FLAG_LAST, { 0x6FFF, 0x6101, 0x8F14 }, { { 0xF, 0x01 } } },
+    // VF = 1 first, then VF = VF + V1 = 2.
+    { "8Fy4 keeps the sum", { "legacy" }, { 0x6FFF, 0x6101, 0x8F14 }, { { 0xF, 0x02 } } },
+    { "8xy5 without a borrow", {}, { 0x6005, 0x6103, 0x8015 }, { { 0x0, 0x02 }, { 0xF, 0x01 } } },
+    { "8xy5 of equal values", {}, { 0x6004, 0x6104, 0x8015 }, { { 0x0, 0x00 }, { 0xF, 0x01 } } },
+    { "8xy5 with a borrow", {}, { 0x6003, 0x6105, 0x8015 }, { { 0x0, 0xFE }, { 0xF, 0x00 } } },
+    { "8Fy5 keeps the flag", FLAG_LAST, { 0x6F05, 0x6103, 0x8F15 }, { { 0xF, 0x01 } } },
+    // VF = 1 first, then VF = VF - V1 = 1 - 3.
+    { "8Fy5 keeps the difference", { "legacy" }, { 0x6F05, 0x6103, 0x8F15 }, { { 0xF, 0xFE } } },
+    { "8xy7 without a borrow", {}, { 0x6003, 0x6105, 0x8017 }, { { 0x0, 0x02 }, { 0xF, 0x01 } } },
+    { "8xy7 with a borrow", {}, { 0x6005, 0x6103, 0x8017 }, { { 0x0, 0xFE }, { 0xF, 0x00 } } },
+    { "8Fy7 keeps the flag", FLAG_LAST, { 0x6F03, 0x6105, 0x8F17 }, { { 0xF, 0x01 } } },
+    // VF = 1 first, then VF = V1 - VF = 5 - 1.
+    { "8Fy7 keeps the difference", { "legacy" }, { 0x6F03, 0x6105, 0x8F17 }, { { 0xF, 0x04 } } },
+    { "Fx33 writes hundreds, tens and ones", {}, { 0x60FE, 0xA300, 0xF033 }, {},
+        { { 0x300, 2 }, { 0x301, 5 }, { 0x302, 4 } }, 0x300 },
+    { "Fx33 pads a single digit", {}, { 0x6009, 0xA300, 0xF033 }, {}, { { 0x300, 0 }, { 0x301, 0 }, { 0x302, 9 } } },
+    { "00EE on an empty stack throws", {}, { 0x00EE }, {}, {}, std::nullopt, true },
+    { "Fx55 leaves I", { "legacy", "schip" }, { 0x6011, 0x6122, 0x6233, 0xA300, 0xF255 }, {},
+        { { 0x300, 0x11 }, { 0x301, 0x22 }, { 0x302, 0x33 }, { 0x303, 0x00 } }, 0x300 },
+    { "Fx55 advances I by x", { "chip48" }, { 0x6011, 0x6122, 0x6233, 0xA300, 0xF255 }, {},
+        { { 0x300, 0x11 }, { 0x301, 0x22 }, { 0x302, 0x33 } }, 0x302 },
+    { "Fx55 advances I by x + 1", { "vip", "xochip" }, { 0x6011, 0x6122, 0x6233, 0xA300, 0xF255 }, {},
+        { { 0x300, 0x11 }, { 0x301, 0x22 }, { 0x302, 0x33 } }, 0x303 },
+    { "Fx65 leaves I", { "legacy", "schip" },
+        { 0x6011, 0x6122, 0x6233, 0xA300, 0xF255, 0x6000, 0x6100, 0x6200, 0xA300, 0xF265 },
+        { { 0x0, 0x11 }, { 0x1, 0x22 }, { 0x2, 0x33 } }, {}, 0x300 },
+    { "Fx65 advances I by x", { "chip48" },
+        { 0x6011, 0x6122, 0x6233, 0xA300, 0xF255, 0x6000, 0x6100, 0x6200, 0xA300, 0xF265 },
+        { { 0x0, 0x11 }, { 0x1, 0x22 }, { 0x2, 0x33 } }, {}, 0x302 },
+    { "Fx65 advances I by x + 1", { "vip", "xochip" },
+        { 0x6011, 0x6122, 0x6233, 0xA300, 0xF255, 0x6000, 0x6100, 0x6200, 0xA300, 0xF265 },
+        { { 0x0, 0x11 }, { 0x1, 0x22 }, { 0x2, 0x33 } }, {}, 0x303 },
+};
+
+struct NoKeys : fakers::InputIO {
+    std::bitset<16> read() override { return {}; }
+};
+
+std::string hex(int value) {
+    std::ostringstream os;
+    os << "0x" << std::hex << value;
+    return os.str();
+}
+
+std::vector<uint8_t> assemble(std::vector<uint16_t> const& program) {
+    std::vector<uint8_t> rom;
+    for (uint16_t opcode : program) {
+        rom.push_back(static_cast<uint8_t>(opcode >> 8));
+        rom.push_back(static_cast<uint8_t>(opcode));
+    }
+    return rom;
+}
+
+// Runs the case's program through `step` on a loaded machine whose state
+// is `state` and describes how the result differs; empty when it matches.
+template <typename State, typename Step>
+std::string check(OpCase const& opCase, State const& state, Step&& step) {
+    for (size_t i = 0; i < opCase.program.size(); ++i) {
+        try {
+            step();
+        } catch (std::exception& e) {
+            return opCase.throws && i + 1 == opCase.program.size() ? "" : "threw \"" + std::string{ e.what() } + "\"";
+        }
+    }
+    if (opCase.throws) {
+        return "did not throw";
+    }
+    for (auto [index, value] : opCase.registers) {
+        if (state.v[index] != value) {
+            return "V" + hex(index).substr(2) + "=" + hex(state.v[index]) + ", expected " + hex(value);
+        }
+    }
+    for (auto [address, value] : opCase.memory) {
+        if (state.memory[address] != value) {
+            return "memory[" + hex(address) + "]=" + hex(state.memory[address]) + ", expected " + hex(value);
+        }
+    }
+    if (opCase.regI && state.regI != *opCase.regI) {
+        return "I=" + hex(state.regI) + ", expected " + hex(*opCase.regI);
+    }
+    return {};
+}
+
+template <typename Quirks>
+std::string runReference(OpCase const& opCase) {
+    auto rom = assemble(opCase.program);
+    fakers::ReferenceChip8<Quirks> reference;
+    reference.load(rom.data(), rom.size());
+    return check(opCase, reference.state(), [&] { reference.step({}); });
+}
+
+template <typename Model, typename Quirks>
+std::string runCore(OpCase const& opCase, fakers::Engine engine) {
+    NoKeys keys;
+    fakers::BasicFakeChip8<fakers::NoTrace, Model, Quirks> core{ engine };
+    core.attachIO(&keys);
+    core.load(assemble(opCase.program));
+    return check(opCase, core.state(), [&] { core.step(); });
+}
+
+// Runs the case on every engine built for the profile and returns the
+// failures as "engine: what".
+template <typename Quirks, typename Machine = void>
+std::vector<std::string> runEverywhere(OpCase const& opCase) {
+    std::vector<std::string> failures;
+    auto note = [&](std::string engine, std::string what) {
+        if (!what.empty()) {
+            failures.push_back(engine + ": " + what);
+        }
+    };
+    note("reference", runReference<Quirks>(opCase));
+    note("interpreter", runCore<fakers::Chip8Model, Quirks>(opCase, fakers::Engine::Interpreter));
+    note("blocks", runCore<fakers::Chip8Model, Quirks>(opCase, fakers::Engine::CachedBlocks));
+    if constexpr (!std::is_void_v<Machine>) {
+        char const* machine = Machine::XO ? "XoChip8 " : "SuperChip8 ";
+        note(machine + std::string{ "interpreter" }, runCore<Machine, Quirks>(opCase, fakers::Engine::Interpreter));
+        note(machine + std::string{ "blocks" }, runCore<Machine, Quirks>(opCase, fakers::Engine::CachedBlocks));
+    }
+    return failures;
+}
+
+struct Profile {
+    char const* name;
+    std::vector<std::string> (*run)(OpCase const&);
+};
+
+constexpr Profile PROFILES[] = {
+    { "legacy", &runEverywhere<fakers::LegacyQuirks> },
+    { "vip", &runEverywhere<fakers::CosmacVipQuirks> },
+    { "chip48", &runEverywhere<fakers::Chip48Quirks> },
+    { "schip", &runEverywhere<fakers::SuperChipQuirks, fakers::SuperChipModel> },
+    { "xochip", &runEverywhere<fakers::XoChipQuirks, fakers::XoChipModel> },
+};
+
+} // namespace
+
+int main() {
+    size_t runs = 0;
+    size_t failed = 0;
+    for (auto const& opCase : CASES) {
+        for (auto const& profile : PROFILES) {
+            if (!opCase.quirks.empty()
+                && std::find(begin(opCase.quirks), end(opCase.quirks), profile.name) == end(opCase.quirks)) {
+                continue;
+            }
+            ++runs;
+            for (auto const& failure : profile.run(opCase)) {
+                std::cerr << "FAIL " << opCase.name << " quirks=" << profile.name << " " << failure << "\n";
+                ++failed;
+            }
+        }
+    }
+    std::cout << "cases=" << CASES.size() << " runs=" << runs << (failed ? " FAILED" : " OK") << "\n";
+    return failed ? 1 : 0;
+}
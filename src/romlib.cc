@@ -0,0 +1,50 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "RomLibrary.h"
+
+int main(int argc, char** argv) {
+    std::string packPath;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--pack" && i + 1 < argc) {
+            packPath = argv[++i];
+        } else {
+            paths.emplace_back(arg);
+        }
+    }
+    if (paths.empty()) {
+        std::cerr << "Wrong number of arguments\n";
+        std::cerr << "<program> [--pack <packFile>] <roms, ROM directories or packs...>";
+        return -1;
+    }
+    try {
+        auto start = std::chrono::steady_clock::now();
+        fakers::RomLibrary library;
+        for (auto const& path : paths) {
+            library.add(path);
+        }
+        std::chrono::duration<double, std::milli> indexTime = std::chrono::steady_clock::now() - start;
+
+        for (auto const& rom : library.entries()) {
+            std::cout << rom.name << " size=" << rom.size << " hash=" << std::hex << std::setw(16)
+                << std::setfill('0') << rom.hash << std::dec << std::setfill(' ') << '\n';
+        }
+        for (auto const& rejected : library.rejected()) {
+            std::cout << rejected.name << " rejected: " << rejected.reason << '\n';
+        }
+        std::cout << std::fixed << std::setprecision(2) << "roms=" << library.entries().size()
+            << " rejected=" << library.rejected().size() << " index=" << indexTime.count() << "ms\n";
+        if (!packPath.empty()) {
+            fakers::writeRomPack(packPath, library.entries());
+        }
+    } catch (std::exception& e) {
+        std::cerr << "ERROR:" << e.what() << "\n";
+        return -1;
+    }
+}
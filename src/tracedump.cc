@@ -0,0 +1,27 @@
+#include <fstream>
+#include <iostream>
+
+#include "TraceRecord.h"
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Wrong number of arguments\n";
+        std::cerr << "<program> <traceFile>";
+        return -1;
+    }
+    std::ifstream in{ argv[1], std::ios::binary };
+    if (!in) {
+        std::cerr << "cannot open " << argv[1] << '\n';
+        return -1;
+    }
+    try {
+        auto records = fakers::readTrace(in);
+        for (size_t i = 0; i < records.size(); ++i) {
+            int nextPc = i + 1 < records.size() ? records[i + 1].pc : -1;
+            std::cout << fakers::formatTraceRecord(records[i], nextPc) << '\n';
+        }
+    } catch (std::exception& e) {
+        std::cerr << "ERROR:" << e.what() << "\n";
+        return -1;
+    }
+}